@@ -3,51 +3,200 @@
 
 #include "nodeTree.h"
 #include "leafTree.h"
+#include "../common/workStealingPool.h"
+#include "../common/treeStats.h"
 #include <iostream>
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
 
-// Macro para seleccionar la implementación
-// Definir USE_LEAF_TREE para usar leafTree, de lo contrario usa nodeTree
-#ifdef USE_LEAF_TREE
-    #define AVL_NODE node
-    #define AVL_TREE leafTree
-#else
-    #define AVL_NODE nodeT
-    #define AVL_TREE nodeTree
-#endif
-
-template<typename T, typename B>
+// Backend de AVLTree: el árbol que guarda los nodos y el tipo de nodo.
+//   nodeBackend  cada nodo guarda un par (nodeTree.h)
+//   leafBackend  los pares están en las hojas y los nodos internos sólo
+//                enrutan (leafTree.h)
+// Lo que depende del backend tiene una definición para cada uno, elegida en
+// compilación con requires sobre Backend::leaf.
+struct nodeBackend {
+    template<typename T, typename B, bool Ranked = false> using tree = nodeTree<T, B, nodePool<nodeT<T, B, Ranked>>>;
+    template<typename T, typename B, bool Ranked = false> using treeNode = nodeT<T, B, Ranked>;
+    static constexpr bool leaf = false;
+    static constexpr bool ranked = false;
+};
+
+struct leafBackend {
+    template<typename T, typename B, bool Ranked = false> using tree = leafTree<T, B, nodePool<node<T, B, Ranked>>>;
+    template<typename T, typename B, bool Ranked = false> using treeNode = node<T, B, Ranked>;
+    static constexpr bool leaf = true;
+    static constexpr bool ranked = false;
+};
+
+// withRank<nodeBackend> o withRank<leafBackend>: los nodos guardan además el
+// tamaño de su subárbol (en leafBackend, sus hojas), lo que da select, rank y
+// count_range en O(log n) a cambio de un size_t por nodo.
+template<typename Backend>
+struct withRank {
+    template<typename T, typename B> using tree = typename Backend::template tree<T, B, true>;
+    template<typename T, typename B> using treeNode = typename Backend::template treeNode<T, B, true>;
+    static constexpr bool leaf = Backend::leaf;
+    static constexpr bool ranked = true;
+};
+
+// Stats: noStats o countingStats (ver common/treeStats.h). Se cuentan find,
+// insert, deleteNode y sus reequilibrados; de las versiones recursivas y de
+// split/join sólo las rotaciones, y nada de las operaciones de conjuntos.
+template<typename T, typename B, typename Backend = nodeBackend, typename Stats = noStats>
 class AVLTree {
+public:
+    typedef typename Backend::template treeNode<T, B> Node;
+    typedef typename Backend::template tree<T, B> Base;
+
 private:
-    AVL_TREE<T, B> baseTree;
+    Base baseTree;
     
     // Funciones auxiliares para AVL
-    int getHeight(AVL_NODE<T, B>* node);
-    int getBalance(AVL_NODE<T, B>* node);
-    void setHeight(AVL_NODE<T, B>* node);
+    int getHeight(Node* node);
+    int getBalance(Node* node);
+    void setHeight(Node* node);
+    static size_t getCount(Node* n) { return n == nullptr ? 0 : n->count; }
+    size_t countBefore(const T& key, bool inclusive) const requires Backend::ranked;
     
     // Rotaciones
-    AVL_NODE<T, B>* rotateRight(AVL_NODE<T, B>* y);
-    AVL_NODE<T, B>* rotateLeft(AVL_NODE<T, B>* x);
+    Node* rotateRight(Node* y);
+    Node* rotateLeft(Node* x);
     
     // Operaciones AVL
-    AVL_NODE<T, B>* insertAVL(T key, B val, AVL_NODE<T, B>* node);
-    AVL_NODE<T, B>* deleteAVL(T key, AVL_NODE<T, B>* node);
-    AVL_NODE<T, B>* getMinNode(AVL_NODE<T, B>* node);
+    Node* insertAVL(T key, B val, Node* node) requires (!Backend::leaf);
+    Node* insertAVL(T key, B val, Node* node) requires Backend::leaf;
+    Node* deleteAVL(T key, Node* node) requires (!Backend::leaf);
+    Node* deleteAVL(T key, Node* node) requires Backend::leaf;
+    Node* getMinNode(Node* node);
+    
+    // Versión iterativa: el camino desde la raíz se guarda en un buffer fijo
+    // (la altura de un AVL con 2^64 nodos no llega a 93) y se reequilibra de
+    // abajo arriba hasta que un subárbol conserva su altura
+    static constexpr int MAX_PATH = 128;
+    Node* rebalance(Node* n);
+    void replaceChild(Node* parent, Node* old, Node* sub);
+    void retrace(Node** path, int depth);
+    size_t rotations = 0;
+    [[no_unique_address]] Stats stats;
+    
+    // Construcción balanceada a partir de n elementos ordenados
+    template<typename It>
+    Node* buildSorted(It& it, size_t n) requires (!Backend::leaf);
+    template<typename It>
+    Node* buildSorted(It& it, size_t n) requires Backend::leaf;
+    
+    // Join y split: m es el nodo que separa l de r
+    Node* joinWith(Node* l, Node* m, Node* r) requires (!Backend::leaf);
+    Node* joinWith(Node* l, Node* m, Node* r) requires Backend::leaf;
+    Node* joinRight(Node* l, Node* m, Node* r);
+    Node* joinLeft(Node* l, Node* m, Node* r);
+    void splitAVL(Node* n, T key, Node*& l, Node*& r) requires (!Backend::leaf);
+    void splitAVL(Node* n, T key, Node*& l, Node*& r) requires Backend::leaf;
+    static size_t joinedSize(size_t left, size_t right) {
+        const size_t unknown = Base::UNKNOWN_SIZE;
+        return (left == unknown || right == unknown) ? unknown : left + right + 1;
+    }
+    
+    // Operaciones de conjuntos en paralelo. Mientras duran, los nodos se
+    // reservan y liberan a través de setOp (ver newNode/freeNode).
+    struct setOpContext;
+    setOpContext* setOp = nullptr;
+    template<typename... Args>
+    Node* newNode(Args&&... args);
+    void freeNode(Node* n);
+    template<typename F, typename G>
+    void forkJoin(int depth, F&& f, G&& g);
+    template<typename Op>
+    void runSetOp(AVLTree& other, workStealingPool& pool, Op op);
+    void freeTree(Node* n, int depth, Node* keep = nullptr);
+    Node* removeMin(Node* n, Node*& min) requires (!Backend::leaf);
+    Node* removeMin(Node* n, Node*& min) requires Backend::leaf;
+    Node* join2(Node* l, Node* r) requires (!Backend::leaf);
+    Node* join2(Node* l, Node* r) requires Backend::leaf;
+    Node* unionAVL(Node* a, Node* b, int depth, size_t& repeated) requires (!Backend::leaf);
+    Node* unionAVL(Node* a, Node* b, int depth, size_t& repeated) requires Backend::leaf;
+    Node* intersectAVL(Node* a, Node* b, int depth, size_t& common) requires (!Backend::leaf);
+    Node* intersectAVL(Node* a, Node* b, int depth, size_t& common) requires Backend::leaf;
+    Node* differenceAVL(Node* a, Node* b, int depth, size_t& removed) requires (!Backend::leaf);
+    Node* differenceAVL(Node* a, Node* b, int depth, size_t& removed) requires Backend::leaf;
+    Node* split3(Node* n, T key, Node*& l, Node*& r) requires (!Backend::leaf);
+    Node* insertLeaf(Node* n, Node* leaf, bool keepExisting, size_t& repeated) requires Backend::leaf;
+    Node* findLeaf(Node* n, T key) requires Backend::leaf;
     
     // Funciones de utilidad
-    void inorderTraversal(AVL_NODE<T, B>* node);
-    void preorderTraversal(AVL_NODE<T, B>* node);
-    void postorderTraversal(AVL_NODE<T, B>* node);
+    void inorderTraversal(Node* node);
+    void preorderTraversal(Node* node);
+    void postorderTraversal(Node* node);
 
 public:
     AVLTree();
     ~AVLTree();
+    AVLTree(AVLTree&&) = default;
+    AVLTree& operator=(AVLTree&&) = default;
     
     // Interfaz pública
-    void insert(T key, B val);
-    void deleteNode(T key);
-    AVL_NODE<T, B>* find(T key);
+    void insert(T key, B val) requires (!Backend::leaf);
+    void insert(T key, B val) requires Backend::leaf;
+    void deleteNode(T key) requires (!Backend::leaf);
+    void deleteNode(T key) requires Backend::leaf;
+    Node* find(T key);
+    
+    // Versiones recursivas originales, como referencia para los benchmarks
+    void insertRecursive(T key, B val);
+    void deleteRecursive(T key);
+    
+    // Rotaciones simples acumuladas (una doble cuenta dos). No incluye las
+    // de las operaciones de conjuntos, que rotan desde varios hilos.
+    size_t getRotations() const { return rotations; }
+    void resetRotations() { rotations = 0; }
+    
+    statsSnapshot getStats() const { return stats.snapshot(); }
+    void resetStats() { stats.reset(); }
+    
+    // Reemplaza el contenido por los pares (clave, valor) de [first, last),
+    // que deben venir ordenados por clave y sin repetidos. O(n).
+    template<typename It>
+    void build_from_sorted(It first, It last);
+    
+    // Parte el árbol en (claves < key, claves >= key) y lo deja vacío.
+    // O(log n). Cada mitad reserva y libera en su propio pool, así que
+    // pueden usarse desde hilos distintos; los slabs donde ya estaban los
+    // nodos siguen vivos mientras alguna de las dos los use. Sin withRank
+    // el tamaño de las mitades queda sin contar: el primer getSize() de
+    // cada una es O(n).
+    std::pair<AVLTree, AVLTree> split(T key);
+    
+    // Une left, (key, val) y right, con left < key < right, y vacía ambos.
+    // O(log n) más O(número de slabs) al pasar el pool de right (ver adopt).
+    static AVLTree join(AVLTree&& left, T key, B val, AVLTree&& right) requires (!Backend::leaf);
+    static AVLTree join(AVLTree&& left, T key, B val, AVLTree&& right) requires Backend::leaf;
+    
+    // Operaciones de conjuntos con other, que queda vacío. Divide y vencerás
+    // sobre split/join repartido en pool: O(m log(n/m + 1)) de trabajo para
+    // tamaños m <= n, más la liberación de los nodos descartados.
+    // En union_with gana el valor de other si la clave está en los dos;
+    // intersect_with conserva los valores de este árbol. Con other == *this
+    // la unión y la intersección no hacen nada y la diferencia lo vacía.
+    void union_with(AVLTree& other, workStealingPool& pool = workStealingPool::global());
+    void intersect_with(AVLTree& other, workStealingPool& pool = workStealingPool::global());
+    void difference_with(AVLTree& other, workStealingPool& pool = workStealingPool::global());
+    
+    size_t getSize() const { return baseTree.getSize(); }
+    memoryUsage memory_usage() const;
+    
+    // Estadísticas de orden, sólo con withRank<...>. O(log n).
+    // select(k): el nodo con la k-ésima clave menor (desde 0), nullptr si
+    // k >= getSize(). rank(key): claves < key. count_range: claves en [lo, hi].
+    Node* select(size_t k) const requires Backend::ranked;
+    size_t rank(const T& key) const requires Backend::ranked { return countBefore(key, false); }
+    size_t count_range(const T& lo, const T& hi) const requires Backend::ranked;
+    
+    // Instantánea de sólo lectura para búsquedas (ver frozenTree.h)
+    frozenTree<T, B> freeze() const;
     
     // Recorridos
     void printInorder();
@@ -57,74 +206,107 @@ public:
     // Verificación del balance
     bool isBalanced();
     int getTreeHeight();
+    
+    Node* _test_root() const { return baseTree.getRoot(); }
 };
 
-// Especialización para nodeTree
-#ifndef USE_LEAF_TREE
+// Común a los dos backends
 
-template<typename T, typename B>
-AVLTree<T, B>::AVLTree() : baseTree() {}
+template<typename T, typename B, typename Backend, typename Stats>
+AVLTree<T, B, Backend, Stats>::AVLTree() : baseTree() {}
 
-template<typename T, typename B>
-AVLTree<T, B>::~AVLTree() {}
+template<typename T, typename B, typename Backend, typename Stats>
+AVLTree<T, B, Backend, Stats>::~AVLTree() {}
 
-template<typename T, typename B>
-int AVLTree<T, B>::getHeight(nodeT<T, B>* node) {
-    if (node == nullptr) return 0;
-    return node->height;
+// Cada nodo guarda su altura (en leafBackend las hojas tienen altura 1), así
+// que getHeight y getBalance son O(1). Con withRank setHeight recalcula
+// también el tamaño del subárbol: todo lo que cambia hijos (rotaciones,
+// inserción, borrado, join) ya pasa por ella.
+template<typename T, typename B, typename Backend, typename Stats>
+int AVLTree<T, B, Backend, Stats>::getHeight(Node* n) {
+    if (n == nullptr) return 0;
+    return n->height;
 }
 
-template<typename T, typename B>
-int AVLTree<T, B>::getBalance(nodeT<T, B>* node) {
-    if (node == nullptr) return 0;
-    return getHeight(node->left) - getHeight(node->right);
+template<typename T, typename B, typename Backend, typename Stats>
+int AVLTree<T, B, Backend, Stats>::getBalance(Node* n) {
+    if (n == nullptr) return 0;
+    return getHeight(n->left) - getHeight(n->right);
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::setHeight(nodeT<T, B>* node) {
-    if (node != nullptr) {
-        node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::setHeight(Node* n) {
+    if (n == nullptr) return;
+    if constexpr (Backend::leaf) {
+        if (n->leaf) return;
+    }
+    n->height = 1 + std::max(getHeight(n->left), getHeight(n->right));
+    if constexpr (Backend::ranked) {
+        n->count = getCount(n->left) + getCount(n->right) + (Backend::leaf ? 0 : 1);
     }
 }
 
-template<typename T, typename B>
-nodeT<T, B>* AVLTree<T, B>::rotateRight(nodeT<T, B>* y) {
-    nodeT<T, B>* x = y->left;
-    nodeT<T, B>* T2 = x->right;
+// En leafBackend la clave de un nodo interno es la mínima de su subárbol
+// derecho (izquierda: key < n->key, derecha: key >= n->key). Una rotación no
+// cambia el subárbol derecho de y, ni el mínimo del subárbol derecho de x,
+// así que las claves de enrutamiento no necesitan actualizarse.
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::rotateRight(Node* y) {
+    Node* x = y->left;
+    Node* T2 = x->right;
     
     // Realizar rotación
     x->right = y;
     y->left = T2;
+    if (setOp == nullptr) {
+        rotations++;
+        stats.rotate();
+    }
     
-    // ¡ACTUALIZAR ALTURAS!
     setHeight(y);
     setHeight(x);
     
     return x;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* AVLTree<T, B>::rotateLeft(nodeT<T, B>* x) {
-    nodeT<T, B>* y = x->right;
-    nodeT<T, B>* T2 = y->left;
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::rotateLeft(Node* x) {
+    Node* y = x->right;
+    Node* T2 = y->left;
     
     // Realizar rotación
     y->left = x;
     x->right = T2;
+    if (setOp == nullptr) {
+        rotations++;
+        stats.rotate();
+    }
     
-    // ¡ACTUALIZAR ALTURAS!
     setHeight(x);
     setHeight(y);
     
     return y;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* AVLTree<T, B>::insertAVL(T key, B val, nodeT<T, B>* node) {
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::getMinNode(Node* n) {
+    if (n == nullptr) return nullptr;
+    
+    // Ir hasta la hoja más a la izquierda
+    while (n->left != nullptr) {
+        n = n->left;
+    }
+    return n;
+}
+
+// Backend nodeBackend: cada definición con requires (!Backend::leaf)
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::insertAVL(T key, B val, Node* node) requires (!Backend::leaf) {
     // 1. Inserción normal de BST
     if (node == nullptr) {
         baseTree.incrementSize();
-        return new nodeT<T, B>(key, val);  // height ya se inicializa en 1
+        return baseTree.createNode(key, val);  // height ya se inicializa en 1
     }
     
     if (key < node->key) {
@@ -170,18 +352,23 @@ nodeT<T, B>* AVLTree<T, B>::insertAVL(T key, B val, nodeT<T, B>* node) {
     return node;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* AVLTree<T, B>::getMinNode(nodeT<T, B>* node) {
-    if (node == nullptr) return nullptr;
+// La mitad izquierda va al subárbol izquierdo; las alturas salen exactas
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename It>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::buildSorted(It& it, size_t n) requires (!Backend::leaf) {
+    if (n == 0) return nullptr;
     
-    while (node->left != nullptr) {
-        node = node->left;
-    }
+    Node* left = buildSorted(it, n / 2);
+    Node* node = baseTree.createNode(it->first, it->second);
+    ++it;
+    node->left = left;
+    node->right = buildSorted(it, n - n / 2 - 1);
+    setHeight(node);
     return node;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* AVLTree<T, B>::deleteAVL(T key, nodeT<T, B>* node) {
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::deleteAVL(T key, Node* node) requires (!Backend::leaf) {
     // 1. Eliminación normal de BST
     if (node == nullptr) return node;
     
@@ -194,7 +381,7 @@ nodeT<T, B>* AVLTree<T, B>::deleteAVL(T key, nodeT<T, B>* node) {
         baseTree.decrementSize();
         
         if (node->left == nullptr || node->right == nullptr) {
-            nodeT<T, B>* temp = node->left ? node->left : node->right;
+            Node* temp = node->left ? node->left : node->right;
             
             if (temp == nullptr) {
                 temp = node;
@@ -202,9 +389,9 @@ nodeT<T, B>* AVLTree<T, B>::deleteAVL(T key, nodeT<T, B>* node) {
             } else {
                 *node = *temp;
             }
-            delete temp;
+            baseTree.destroyNode(temp);
         } else {
-            nodeT<T, B>* temp = getMinNode(node->right);
+            Node* temp = getMinNode(node->right);
             
             node->key = temp->key;
             node->val = temp->val;
@@ -247,92 +434,239 @@ nodeT<T, B>* AVLTree<T, B>::deleteAVL(T key, nodeT<T, B>* node) {
     return node;
 }
 
-#else
+// Inserción iterativa: tras una rotación el subárbol recupera la altura que
+// tenía antes de insertar, así que hay como mucho una (simple o doble)
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::insert(T key, B val) requires (!Backend::leaf) {
+    Node* path[MAX_PATH];
+    int depth = 0;
+    Node* n = baseTree.getRoot();
+    while (n != nullptr) {
+        stats.visit();
+        stats.compare();
+        if (key == n->key) {
+            n->val = val;
+            return;
+        }
+        path[depth++] = n;
+        stats.compare();
+        n = key < n->key ? n->left : n->right;
+    }
+    
+    baseTree.incrementSize();
+    n = baseTree.createNode(key, val);
+    if (depth == 0) {
+        baseTree.setRoot(n);
+        return;
+    }
+    Node* parent = path[depth - 1];
+    stats.compare();
+    if (key < parent->key) parent->left = n;
+    else parent->right = n;
+    retrace(path, depth);
+}
 
-template<typename T, typename B>
-AVLTree<T, B>::AVLTree() : baseTree() {}
+// Con dos hijos se copia el sucesor y se elimina éste, que no tiene hijo
+// izquierdo; su hijo derecho ocupa su lugar
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::deleteNode(T key) requires (!Backend::leaf) {
+    Node* path[MAX_PATH];
+    int depth = 0;
+    Node* n = baseTree.getRoot();
+    while (n != nullptr && key != n->key) {
+        stats.visit();
+        stats.compare();
+        path[depth++] = n;
+        stats.compare();
+        n = key < n->key ? n->left : n->right;
+    }
+    if (n == nullptr) return;
+    stats.visit();
+    stats.compare();
+    baseTree.decrementSize();
+    
+    Node* removed = n;
+    if (n->left != nullptr && n->right != nullptr) {
+        path[depth++] = n;
+        removed = n->right;
+        while (removed->left != nullptr) {
+            stats.visit();
+            path[depth++] = removed;
+            removed = removed->left;
+        }
+        n->key = removed->key;
+        n->val = removed->val;
+    }
+    
+    Node* child = removed->left ? removed->left : removed->right;
+    replaceChild(depth > 0 ? path[depth - 1] : nullptr, removed, child);
+    baseTree.destroyNode(removed);
+    retrace(path, depth);
+}
 
-template<typename T, typename B>
-AVLTree<T, B>::~AVLTree() {}
+// Los subárboles vacíos valen: node queda como mínimo o máximo del resultado
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::joinWith(Node* l, Node* node, Node* r) requires (!Backend::leaf) {
+    if (getHeight(l) > getHeight(r) + 1) return joinRight(l, node, r);
+    if (getHeight(r) > getHeight(l) + 1) return joinLeft(l, node, r);
+    node->left = l;
+    node->right = r;
+    setHeight(node);
+    return node;
+}
 
-template<typename T, typename B>
-int AVLTree<T, B>::getHeight(node<T, B>* n) {
-    if (n == nullptr) return 0;
-    
-    // Para leafTree, las hojas tienen altura 1
-    if (n->leaf) return 1;
+// Como splitAVL, pero el nodo con clave key (si existe) queda fuera de las
+// dos mitades y se devuelve
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::split3(Node* node, T key, Node*& l, Node*& r) requires (!Backend::leaf) {
+    if (node == nullptr) {
+        l = r = nullptr;
+        return nullptr;
+    }
     
-    int leftHeight = getHeight(n->left);
-    int rightHeight = getHeight(n->right);
-    return 1 + std::max(leftHeight, rightHeight);
+    Node* left = node->left;
+    Node* right = node->right;
+    if (key < node->key) {
+        Node* found = split3(left, key, l, r);
+        r = joinWith(r, node, right);
+        return found;
+    }
+    if (key > node->key) {
+        Node* found = split3(right, key, l, r);
+        l = joinWith(left, node, l);
+        return found;
+    }
+    l = left;
+    r = right;
+    return node;
 }
 
-template<typename T, typename B>
-int AVLTree<T, B>::getBalance(node<T, B>* n) {
-    if (n == nullptr) return 0;
-    return getHeight(n->left) - getHeight(n->right);
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::splitAVL(Node* node, T key, Node*& l, Node*& r) requires (!Backend::leaf) {
+    Node* found = split3(node, key, l, r);
+    if (found != nullptr) {
+        r = joinWith(nullptr, found, r);
+    }
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::setHeight(node<T, B>* n) {
-    // Para leafTree no necesitamos almacenar altura explícitamente
-    // ya que se calcula dinámicamente
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::removeMin(Node* node, Node*& min) requires (!Backend::leaf) {
+    if (node->left == nullptr) {
+        min = node;
+        return node->right;
+    }
+    Node* left = removeMin(node->left, min);
+    return joinWith(left, node, node->right);
 }
 
-template<typename T, typename B>
-node<T, B>* AVLTree<T, B>::rotateRight(node<T, B>* y) {
-    node<T, B>* x = y->left;
-    node<T, B>* T2 = x->right;
-    
-    // Realizar rotación
-    x->right = y;
-    y->left = T2;
+// Concatena l < r sin nodo intermedio: se usa el mínimo de r
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::join2(Node* l, Node* r) requires (!Backend::leaf) {
+    if (r == nullptr) return l;
+    Node* min;
+    r = removeMin(r, min);
+    return joinWith(l, min, r);
+}
+
+// Los nodos de a se reutilizan como pivotes; de b sólo se liberan los repetidos
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::unionAVL(Node* a, Node* b, int depth, size_t& repeated) requires (!Backend::leaf) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
     
-    // Actualizar la clave del nodo y después de la rotación
-    // En leafTree, los nodos internos mantienen la clave máxima de su subárbol
-    updateInternalNodeKey(y);
-    updateInternalNodeKey(x);
+    Node *l2, *r2;
+    Node* found = split3(b, a->key, l2, r2);
+    if (found != nullptr) {
+        a->val = found->val;
+        freeNode(found);
+        repeated++;
+    }
     
-    return x;
+    Node* l1 = a->left;
+    Node* r1 = a->right;
+    Node *l, *r;
+    size_t repeatedLeft = 0, repeatedRight = 0;
+    forkJoin(depth,
+             [&] { l = unionAVL(l1, l2, depth + 1, repeatedLeft); },
+             [&] { r = unionAVL(r1, r2, depth + 1, repeatedRight); });
+    repeated += repeatedLeft + repeatedRight;
+    return joinWith(l, a, r);
 }
 
-template<typename T, typename B>
-node<T, B>* AVLTree<T, B>::rotateLeft(node<T, B>* x) {
-    node<T, B>* y = x->right;
-    node<T, B>* T2 = y->left;
-    
-    // Realizar rotación
-    y->left = x;
-    x->right = T2;
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::intersectAVL(Node* a, Node* b, int depth, size_t& common) requires (!Backend::leaf) {
+    if (a == nullptr || b == nullptr) {
+        forkJoin(depth, [&] { freeTree(a, depth + 1); }, [&] { freeTree(b, depth + 1); });
+        return nullptr;
+    }
     
-    // Actualizar claves después de la rotación
-    updateInternalNodeKey(x);
-    updateInternalNodeKey(y);
+    Node *l2, *r2;
+    Node* found = split3(b, a->key, l2, r2);
+    Node* l1 = a->left;
+    Node* r1 = a->right;
+    Node *l, *r;
+    size_t commonLeft = 0, commonRight = 0;
+    forkJoin(depth,
+             [&] { l = intersectAVL(l1, l2, depth + 1, commonLeft); },
+             [&] { r = intersectAVL(r1, r2, depth + 1, commonRight); });
+    common += commonLeft + commonRight;
     
-    return y;
+    if (found != nullptr) {
+        freeNode(found);
+        common++;
+        return joinWith(l, a, r);
+    }
+    freeNode(a);
+    return join2(l, r);
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::updateInternalNodeKey(node<T, B>* n) {
-    if (n == nullptr || n->leaf) return;
-    
-    // Para leafTree, la clave del nodo interno debe ser la máxima de su subárbol derecho
-    node<T, B>* rightmost = n->right;
-    while (rightmost != nullptr && !rightmost->leaf) {
-        rightmost = rightmost->right;
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::differenceAVL(Node* a, Node* b, int depth, size_t& removed) requires (!Backend::leaf) {
+    if (a == nullptr) {
+        freeTree(b, depth);
+        return nullptr;
     }
+    if (b == nullptr) return a;
     
-    if (rightmost != nullptr) {
-        n->key = rightmost->key;
+    Node *l1, *r1;
+    Node* found = split3(a, b->key, l1, r1);
+    Node* l2 = b->left;
+    Node* r2 = b->right;
+    freeNode(b);
+    if (found != nullptr) {
+        freeNode(found);
+        removed++;
     }
+    
+    Node *l, *r;
+    size_t removedLeft = 0, removedRight = 0;
+    forkJoin(depth,
+             [&] { l = differenceAVL(l1, l2, depth + 1, removedLeft); },
+             [&] { r = differenceAVL(r1, r2, depth + 1, removedRight); });
+    removed += removedLeft + removedRight;
+    return join2(l, r);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+AVLTree<T, B, Backend, Stats> AVLTree<T, B, Backend, Stats>::join(AVLTree&& left, T key, B val, AVLTree&& right) requires (!Backend::leaf) {
+    AVLTree result(std::move(left));
+    size_t leftSize = result.baseTree.cachedSize();
+    size_t rightSize = right.baseTree.cachedSize();
+    Node* r = result.baseTree.adopt(right.baseTree);
+    Node* m = result.baseTree.createNode(key, val);
+    result.baseTree.setRoot(result.joinWith(result.baseTree.getRoot(), m, r));
+    result.baseTree.setSize(joinedSize(leftSize, rightSize));
+    return result;
 }
 
-template<typename T, typename B>
-node<T, B>* AVLTree<T, B>::insertAVL(T key, B val, node<T, B>* n) {
+// Backend leafBackend: cada definición con requires Backend::leaf
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::insertAVL(T key, B val, Node* n) requires Backend::leaf {
     // Caso base: árbol vacío
     if (n == nullptr) {
         baseTree.incrementSize();
-        return new node<T, B>(key, val, nullptr, nullptr, true);
+        return baseTree.createNode(key, val, nullptr, nullptr, true);
     }
     
     // Si llegamos a una hoja, necesitamos expandirla
@@ -345,9 +679,9 @@ node<T, B>* AVLTree<T, B>::insertAVL(T key, B val, node<T, B>* n) {
         
         baseTree.incrementSize();
         
-        // Crear nuevo nodo interno
-        node<T, B>* newInternal = new node<T, B>(std::max(key, n->key), B{}, nullptr, nullptr, false);
-        node<T, B>* newLeaf = new node<T, B>(key, val, nullptr, nullptr, true);
+        // Nuevo nodo interno con la clave de la hoja derecha
+        Node* newInternal = baseTree.createNode(std::max(key, n->key), B{}, nullptr, nullptr, false);
+        Node* newLeaf = baseTree.createNode(key, val, nullptr, nullptr, true);
         
         // Organizar los hijos según las claves
         if (key < n->key) {
@@ -357,100 +691,90 @@ node<T, B>* AVLTree<T, B>::insertAVL(T key, B val, node<T, B>* n) {
             newInternal->left = n;
             newInternal->right = newLeaf;
         }
+        setHeight(newInternal);
         
         return newInternal;
     }
     
-    // Navegación en nodo interno (similar a BST)
-    if (key <= n->key) {
+    // Navegación en nodo interno (igual que leafTree::find)
+    if (key < n->key) {
         n->left = insertAVL(key, val, n->left);
     } else {
         n->right = insertAVL(key, val, n->right);
     }
     
-    // Actualizar la clave del nodo interno
-    updateInternalNodeKey(n);
+    setHeight(n);
     
     // Verificar balance y aplicar rotaciones si es necesario
     int balance = getBalance(n);
     
-    // Rotación derecha (Left-Left case)
-    if (balance > 1 && key <= (n->left ? n->left->key : key)) {
-        return rotateRight(n);
-    }
-    
-    // Rotación izquierda (Right-Right case)
-    if (balance < -1 && key > (n->right ? n->right->key : key)) {
-        return rotateLeft(n);
-    }
-    
-    // Rotación Left-Right
-    if (balance > 1 && key > (n->left ? n->left->key : key)) {
-        n->left = rotateLeft(n->left);
+    if (balance > 1) {
+        // Rotación Left-Right
+        if (getBalance(n->left) < 0) {
+            n->left = rotateLeft(n->left);
+        }
         return rotateRight(n);
     }
     
-    // Rotación Right-Left
-    if (balance < -1 && key <= (n->right ? n->right->key : key)) {
-        n->right = rotateRight(n->right);
+    if (balance < -1) {
+        // Rotación Right-Left
+        if (getBalance(n->right) > 0) {
+            n->right = rotateRight(n->right);
+        }
         return rotateLeft(n);
     }
     
     return n;
 }
 
-template<typename T, typename B>
-node<T, B>* AVLTree<T, B>::getMinNode(node<T, B>* n) {
-    if (n == nullptr) return nullptr;
-    
-    // Ir hasta la hoja más a la izquierda
-    while (n->left != nullptr) {
-        n = n->left;
+// n hojas: la clave de cada nodo interno es la primera de su mitad derecha
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename It>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::buildSorted(It& it, size_t n) requires Backend::leaf {
+    if (n == 0) return nullptr;
+    if (n == 1) {
+        Node* leaf = baseTree.createNode(it->first, it->second, nullptr, nullptr, true);
+        ++it;
+        return leaf;
     }
-    return n;
+    
+    Node* left = buildSorted(it, n / 2);
+    T routingKey = it->first;
+    Node* right = buildSorted(it, n - n / 2);
+    Node* internal = baseTree.createNode(routingKey, B{}, left, right, false);
+    setHeight(internal);
+    return internal;
 }
 
-template<typename T, typename B>
-node<T, B>* AVLTree<T, B>::deleteAVL(T key, node<T, B>* n) {
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::deleteAVL(T key, Node* n) requires Backend::leaf {
     if (n == nullptr) return nullptr;
     
     // Si es una hoja
     if (n->leaf) {
         if (n->key == key) {
             baseTree.decrementSize();
-            delete n;
+            baseTree.destroyNode(n);
             return nullptr;
         }
         return n;
     }
     
     // Navegación en nodo interno
-    if (key <= n->key) {
+    if (key < n->key) {
         n->left = deleteAVL(key, n->left);
     } else {
         n->right = deleteAVL(key, n->right);
     }
     
-    // Manejar el caso donde un hijo se vuelve nullptr
-    if (n->left == nullptr && n->right != nullptr) {
-        node<T, B>* temp = n->right;
-        delete n;
-        return temp;
-    }
-    if (n->right == nullptr && n->left != nullptr) {
-        node<T, B>* temp = n->left;
-        delete n;
+    // Si se eliminó una hoja hija, el hermano sube a ocupar el nodo interno
+    if (n->left == nullptr || n->right == nullptr) {
+        Node* temp = n->left ? n->left : n->right;
+        baseTree.destroyNode(n);
         return temp;
     }
     
-    // Si ambos hijos son nullptr, el nodo debe ser eliminado
-    if (n->left == nullptr && n->right == nullptr) {
-        delete n;
-        return nullptr;
-    }
-    
-    // Actualizar la clave del nodo interno
-    updateInternalNodeKey(n);
+    setHeight(n);
     
     // Verificar balance y aplicar rotaciones
     int balance = getBalance(n);
@@ -479,114 +803,731 @@ node<T, B>* AVLTree<T, B>::deleteAVL(T key, node<T, B>* n) {
     
     return n;
 }
-#endif
+
+// Inserción iterativa: la hoja alcanzada se sustituye por un nodo interno con
+// las dos hojas; después basta como mucho una rotación (simple o doble)
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::insert(T key, B val) requires Backend::leaf {
+    Node* path[MAX_PATH];
+    int depth = 0;
+    Node* n = baseTree.getRoot();
+    if (n == nullptr) {
+        baseTree.incrementSize();
+        baseTree.setRoot(baseTree.createNode(key, val, nullptr, nullptr, true));
+        return;
+    }
+    while (!n->leaf) {
+        stats.visit();
+        stats.compare();
+        path[depth++] = n;
+        n = key < n->key ? n->left : n->right;
+    }
+    stats.visit();
+    stats.compare();
+    if (n->key == key) {
+        n->val = val;
+        return;
+    }
+    
+    baseTree.incrementSize();
+    Node* newLeaf = baseTree.createNode(key, val, nullptr, nullptr, true);
+    stats.compare();
+    Node* newInternal = key < n->key
+        ? baseTree.createNode(n->key, B{}, newLeaf, n, false)
+        : baseTree.createNode(key, B{}, n, newLeaf, false);
+    setHeight(newInternal);
+    replaceChild(depth > 0 ? path[depth - 1] : nullptr, n, newInternal);
+    retrace(path, depth);
+}
+
+// El hermano de la hoja eliminada ocupa el lugar de su padre
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::deleteNode(T key) requires Backend::leaf {
+    Node* path[MAX_PATH];
+    int depth = 0;
+    Node* n = baseTree.getRoot();
+    if (n == nullptr) return;
+    while (!n->leaf) {
+        stats.visit();
+        stats.compare();
+        path[depth++] = n;
+        n = key < n->key ? n->left : n->right;
+    }
+    stats.visit();
+    stats.compare();
+    if (n->key != key) return;
+    baseTree.decrementSize();
+    baseTree.destroyNode(n);
+    if (depth == 0) {
+        baseTree.setRoot(nullptr);
+        return;
+    }
+    
+    Node* parent = path[--depth];
+    Node* sibling = parent->left == n ? parent->right : parent->left;
+    replaceChild(depth > 0 ? path[depth - 1] : nullptr, parent, sibling);
+    baseTree.destroyNode(parent);
+    retrace(path, depth);
+}
+
+// m es un nodo interno cuya clave separa l de r (l < clave <= r). Si uno de
+// los dos lados está vacío m sobra y se libera.
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::joinWith(Node* l, Node* m, Node* r) requires Backend::leaf {
+    if (l == nullptr || r == nullptr) {
+        freeNode(m);
+        return l ? l : r;
+    }
+    
+    if (getHeight(l) > getHeight(r) + 1) return joinRight(l, m, r);
+    if (getHeight(r) > getHeight(l) + 1) return joinLeft(l, m, r);
+    m->left = l;
+    m->right = r;
+    setHeight(m);
+    return m;
+}
+
+// Cada nodo interno del camino se reutiliza como separador de lo que queda
+// a cada lado, así que split no reserva memoria.
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::splitAVL(Node* n, T key, Node*& l, Node*& r) requires Backend::leaf {
+    if (n == nullptr) {
+        l = r = nullptr;
+        return;
+    }
+    
+    if (n->leaf) {
+        l = (n->key < key) ? n : nullptr;
+        r = (n->key < key) ? nullptr : n;
+        return;
+    }
+    
+    Node* left = n->left;
+    Node* right = n->right;
+    if (key < n->key) {
+        splitAVL(left, key, l, r);
+        r = joinWith(r, n, right);
+    } else {
+        splitAVL(right, key, l, r);
+        l = joinWith(left, n, l);
+    }
+}
+
+// Quita la hoja mínima (que se devuelve en min) reutilizando los nodos
+// internos del borde izquierdo como separadores
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::removeMin(Node* n, Node*& min) requires Backend::leaf {
+    if (n->leaf) {
+        min = n;
+        return nullptr;
+    }
+    if (n->left->leaf) {
+        min = n->left;
+        Node* right = n->right;
+        freeNode(n);
+        return right;
+    }
+    Node* left = removeMin(n->left, min);
+    return joinWith(left, n, n->right);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::join2(Node* l, Node* r) requires Backend::leaf {
+    if (l == nullptr) return r;
+    if (r == nullptr) return l;
+    return joinWith(l, newNode(getMinNode(r)->key, B{}, nullptr, nullptr, false), r);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::findLeaf(Node* n, T key) requires Backend::leaf {
+    while (n != nullptr && !n->leaf) {
+        n = (key < n->key) ? n->left : n->right;
+    }
+    return (n != nullptr && n->key == key) ? n : nullptr;
+}
+
+// Inserta una hoja ya creada. Con la clave repetida se queda la hoja de n
+// (con su valor si keepExisting, o con el de leaf si no) y leaf se libera.
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::insertLeaf(Node* n, Node* leaf, bool keepExisting, size_t& repeated) requires Backend::leaf {
+    if (n->leaf) {
+        if (n->key == leaf->key) {
+            if (!keepExisting) n->val = leaf->val;
+            freeNode(leaf);
+            repeated++;
+            return n;
+        }
+        Node* internal = newNode(std::max(n->key, leaf->key), B{}, nullptr, nullptr, false);
+        internal->left = (leaf->key < n->key) ? leaf : n;
+        internal->right = (leaf->key < n->key) ? n : leaf;
+        setHeight(internal);
+        return internal;
+    }
+    
+    if (leaf->key < n->key) {
+        return joinWith(insertLeaf(n->left, leaf, keepExisting, repeated), n, n->right);
+    }
+    return joinWith(n->left, n, insertLeaf(n->right, leaf, keepExisting, repeated));
+}
+
+// Los nodos internos de a hacen de pivote: b se parte por su clave de
+// enrutamiento y a se reconstruye con join
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::unionAVL(Node* a, Node* b, int depth, size_t& repeated) requires Backend::leaf {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+    if (a->leaf) return insertLeaf(b, a, true, repeated);
+    if (b->leaf) return insertLeaf(a, b, false, repeated);
+    
+    Node *l2, *r2;
+    splitAVL(b, a->key, l2, r2);
+    Node* l1 = a->left;
+    Node* r1 = a->right;
+    Node *l, *r;
+    size_t repeatedLeft = 0, repeatedRight = 0;
+    forkJoin(depth,
+             [&] { l = unionAVL(l1, l2, depth + 1, repeatedLeft); },
+             [&] { r = unionAVL(r1, r2, depth + 1, repeatedRight); });
+    repeated += repeatedLeft + repeatedRight;
+    return joinWith(l, a, r);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::intersectAVL(Node* a, Node* b, int depth, size_t& common) requires Backend::leaf {
+    if (a == nullptr || b == nullptr) {
+        forkJoin(depth, [&] { freeTree(a, depth + 1); }, [&] { freeTree(b, depth + 1); });
+        return nullptr;
+    }
+    if (a->leaf || b->leaf) {
+        // Se conserva la hoja de a con la clave de la hoja suelta, si existe
+        Node* kept = a->leaf ? (findLeaf(b, a->key) ? a : nullptr) : findLeaf(a, b->key);
+        freeTree(a, depth, kept);
+        freeTree(b, depth);
+        if (kept != nullptr) common++;
+        return kept;
+    }
+    
+    Node *l2, *r2;
+    splitAVL(b, a->key, l2, r2);
+    Node* l1 = a->left;
+    Node* r1 = a->right;
+    Node *l, *r;
+    size_t commonLeft = 0, commonRight = 0;
+    forkJoin(depth,
+             [&] { l = intersectAVL(l1, l2, depth + 1, commonLeft); },
+             [&] { r = intersectAVL(r1, r2, depth + 1, commonRight); });
+    common += commonLeft + commonRight;
+    return joinWith(l, a, r);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::differenceAVL(Node* a, Node* b, int depth, size_t& removed) requires Backend::leaf {
+    if (a == nullptr) {
+        freeTree(b, depth);
+        return nullptr;
+    }
+    if (b == nullptr) return a;
+    
+    if (b->leaf) {
+        Node *l1, *r1;
+        splitAVL(a, b->key, l1, r1);
+        if (r1 != nullptr && getMinNode(r1)->key == b->key) {
+            Node* min;
+            r1 = removeMin(r1, min);
+            freeNode(min);
+            removed++;
+        }
+        freeNode(b);
+        return join2(l1, r1);
+    }
+    if (a->leaf) {
+        bool found = findLeaf(b, a->key) != nullptr;
+        freeTree(b, depth);
+        if (!found) return a;
+        freeNode(a);
+        removed++;
+        return nullptr;
+    }
+    
+    Node *l2, *r2;
+    splitAVL(b, a->key, l2, r2);
+    Node* l1 = a->left;
+    Node* r1 = a->right;
+    Node *l, *r;
+    size_t removedLeft = 0, removedRight = 0;
+    forkJoin(depth,
+             [&] { l = differenceAVL(l1, l2, depth + 1, removedLeft); },
+             [&] { r = differenceAVL(r1, r2, depth + 1, removedRight); });
+    removed += removedLeft + removedRight;
+    return joinWith(l, a, r);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+AVLTree<T, B, Backend, Stats> AVLTree<T, B, Backend, Stats>::join(AVLTree&& left, T key, B val, AVLTree&& right) requires Backend::leaf {
+    AVLTree result(std::move(left));
+    size_t leftSize = result.baseTree.cachedSize();
+    size_t rightSize = right.baseTree.cachedSize();
+    Node* r = result.baseTree.adopt(right.baseTree);
+    
+    // Primero la hoja de key a la derecha de left, luego right con su mínimo
+    // como separador
+    Node* l = result.baseTree.getRoot();
+    Node* leaf = result.baseTree.createNode(key, val, nullptr, nullptr, true);
+    l = result.joinWith(l, result.baseTree.createNode(key, B{}, nullptr, nullptr, false), leaf);
+    if (r != nullptr) {
+        T separator = result.getMinNode(r)->key;
+        l = result.joinWith(l, result.baseTree.createNode(separator, B{}, nullptr, nullptr, false), r);
+    }
+    result.baseTree.setRoot(l);
+    result.baseTree.setSize(joinedSize(leftSize, rightSize));
+    return result;
+}
 
 // Implementaciones comunes para ambas especializaciones
-template<typename T, typename B>
-void AVLTree<T, B>::insert(T key, B val) {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::insertRecursive(T key, B val) {
     // Usar setRoot en lugar de acceso directo a baseTree.root
     baseTree.setRoot(insertAVL(key, val, baseTree.getRoot()));
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::deleteNode(T key) {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::deleteRecursive(T key) {
     // Usar setRoot en lugar de acceso directo a baseTree.root
     baseTree.setRoot(deleteAVL(key, baseTree.getRoot()));
 }
 
-template<typename T, typename B>
-AVL_NODE<T, B>* AVLTree<T, B>::find(T key) {
-    return baseTree.find(key);
+// Actualiza la altura de n y, si quedó desbalanceado, aplica la rotación
+// correspondiente. Devuelve la nueva raíz del subárbol.
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::rebalance(Node* n) {
+    setHeight(n);
+    int balance = getBalance(n);
+    if (balance > 1) {
+        if (getBalance(n->left) < 0) {
+            n->left = rotateLeft(n->left);
+        }
+        return rotateRight(n);
+    }
+    if (balance < -1) {
+        if (getBalance(n->right) > 0) {
+            n->right = rotateRight(n->right);
+        }
+        return rotateLeft(n);
+    }
+    return n;
+}
+
+// parent == nullptr: old era la raíz
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::replaceChild(Node* parent, Node* old, Node* sub) {
+    if (parent == nullptr) baseTree.setRoot(sub);
+    else if (parent->left == old) parent->left = sub;
+    else parent->right = sub;
+}
+
+// Recorre path[depth - 1] .. path[0], cuyas alturas aún son las de antes del
+// cambio, y se detiene en cuanto un subárbol (rotado o no) conserva la suya:
+// por encima nada cambia. Salvo los tamaños de withRank, que cambian hasta la
+// raíz.
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::retrace(Node** path, int depth) {
+    for (int i = depth - 1; i >= 0; i--) {
+        stats.fixup();
+        Node* n = path[i];
+        int before = n->height;
+        Node* sub = rebalance(n);
+        if (sub != n) replaceChild(i > 0 ? path[i - 1] : nullptr, n, sub);
+        if (sub->height == before) {
+            if constexpr (Backend::ranked) {
+                while (--i >= 0) setHeight(path[i]);
+            }
+            return;
+        }
+    }
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::find(T key) {
+    if constexpr (!Stats::enabled) {
+        return baseTree.find(key);
+    } else {
+        // La misma búsqueda que baseTree.find, contando nodos y comparaciones
+        stats.beginSearch();
+        Node* n = baseTree.getRoot();
+        if constexpr (Backend::leaf) {
+            while (n != nullptr && !n->leaf) {
+                stats.visit();
+                stats.compare();
+                n = key < n->key ? n->left : n->right;
+            }
+            if (n != nullptr) {
+                stats.visit();
+                stats.compare();
+                if (n->key != key) n = nullptr;
+            }
+        } else {
+            while (n != nullptr) {
+                stats.visit();
+                stats.compare();
+                if (key == n->key) break;
+                stats.compare();
+                n = key < n->key ? n->left : n->right;
+            }
+        }
+        stats.endSearch();
+        return n;
+    }
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename It>
+void AVLTree<T, B, Backend, Stats>::build_from_sorted(It first, It last) {
+    size_t n = std::distance(first, last);
+    baseTree.clear();
+    baseTree.setRoot(buildSorted(first, n));
+    baseTree.setSize(n);
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::inorderTraversal(AVL_NODE<T, B>* node) {
+// Precondición: h(l) > h(r) + 1. Baja por el borde derecho de l hasta un
+// subárbol de altura h(r) o h(r) + 1 y cuelga ahí m; al subir se reequilibra
+// como en la inserción.
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::joinRight(Node* l, Node* m, Node* r) {
+    Node* c = l->right;
+    if (getHeight(c) <= getHeight(r) + 1) {
+        m->left = c;
+        m->right = r;
+        setHeight(m);
+        l->right = m;
+    } else {
+        l->right = joinRight(c, m, r);
+    }
+    setHeight(l);
+    
+    if (getBalance(l) < -1) {
+        if (getBalance(l->right) > 0) {
+            l->right = rotateRight(l->right);
+        }
+        return rotateLeft(l);
+    }
+    return l;
+}
+
+// Simétrico: h(r) > h(l) + 1
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::joinLeft(Node* l, Node* m, Node* r) {
+    Node* c = r->left;
+    if (getHeight(c) <= getHeight(l) + 1) {
+        m->left = l;
+        m->right = c;
+        setHeight(m);
+        r->left = m;
+    } else {
+        r->left = joinLeft(l, m, c);
+    }
+    setHeight(r);
+    
+    if (getBalance(r) > 1) {
+        if (getBalance(r->left) < 0) {
+            r->left = rotateLeft(r->left);
+        }
+        return rotateRight(r);
+    }
+    return r;
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+std::pair<AVLTree<T, B, Backend, Stats>, AVLTree<T, B, Backend, Stats>> AVLTree<T, B, Backend, Stats>::split(T key) {
+    Node* l;
+    Node* r;
+    splitAVL(baseTree.getRoot(), key, l, r);
+    baseTree.setRoot(nullptr);
+    
+    // left se queda con el pool de este árbol; right tendrá uno propio y
+    // mantiene vivo el de left, donde siguen sus nodos
+    AVLTree left, right;
+    left.baseTree = std::move(baseTree);
+    left.baseTree.setRoot(l);
+    right.baseTree.borrowPools(left.baseTree);
+    right.baseTree.setRoot(r);
+    // Con withRank los tamaños están en las raíces; si no, se cuentan al pedirlos
+    if constexpr (Backend::ranked) {
+        left.baseTree.setSize(getCount(l));
+        right.baseTree.setSize(getCount(r));
+    } else {
+        left.baseTree.setSize(Base::UNKNOWN_SIZE);
+        right.baseTree.setSize(Base::UNKNOWN_SIZE);
+    }
+    return std::make_pair(std::move(left), std::move(right));
+}
+
+// Cada trabajador libera en su propia chain y reserva primero de ella; sólo
+// si está vacía se pide al pool compartido, con el mutex.
+template<typename T, typename B, typename Backend, typename Stats>
+struct AVLTree<T, B, Backend, Stats>::setOpContext {
+    workStealingPool& pool;
+    int forkDepth; // sólo se reparten los niveles superiores de la recursión
+    std::mutex allocMutex;
+    std::vector<typename Base::retireChain> chains;
+    
+    explicit setOpContext(workStealingPool& p) : pool(p), forkDepth(0), chains(p.size()) {
+        if (p.size() > 1) {
+            while ((1u << forkDepth) < p.size()) forkDepth++;
+            forkDepth += 4;
+        }
+    }
+};
+
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename... Args>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::newNode(Args&&... args) {
+    if (setOp == nullptr) return baseTree.createNode(std::forward<Args>(args)...);
+    
+    auto& chain = setOp->chains[workStealingPool::currentWorker()];
+    Node* n = baseTree.reuseNode(chain, args...);
+    if (n == nullptr) {
+        std::lock_guard<std::mutex> lock(setOp->allocMutex);
+        n = baseTree.createNode(std::forward<Args>(args)...);
+    }
+    return n;
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::freeNode(Node* n) {
+    if (setOp == nullptr) {
+        baseTree.destroyNode(n);
+    } else {
+        baseTree.retireNode(setOp->chains[workStealingPool::currentWorker()], n);
+    }
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename F, typename G>
+void AVLTree<T, B, Backend, Stats>::forkJoin(int depth, F&& f, G&& g) {
+    if (depth < setOp->forkDepth) {
+        setOp->pool.invoke(f, g);
+    } else {
+        f();
+        g();
+    }
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::freeTree(Node* n, int depth, Node* keep) {
+    if (n == nullptr) return;
+    Node* left = n->left;
+    Node* right = n->right;
+    if (n != keep) freeNode(n);
+    forkJoin(depth,
+             [&] { freeTree(left, depth + 1, keep); },
+             [&] { freeTree(right, depth + 1, keep); });
+}
+
+// Los nodos de other pasan al pool de este árbol antes de empezar; al acabar
+// las chains de los trabajadores vuelven a su lista libre.
+template<typename T, typename B, typename Backend, typename Stats>
+template<typename Op>
+void AVLTree<T, B, Backend, Stats>::runSetOp(AVLTree& other, workStealingPool& pool, Op op) {
+    Node* a = baseTree.getRoot();
+    Node* b = baseTree.adopt(other.baseTree);
+    setOpContext ctx(pool);
+    setOp = &ctx;
+    Node* result;
+    pool.run([&] { result = op(a, b); });
+    setOp = nullptr;
+    for (auto& chain : ctx.chains) {
+        baseTree.reclaim(chain);
+    }
+    baseTree.setRoot(result);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::union_with(AVLTree& other, workStealingPool& pool) {
+    if (&other == this) return;
+    size_t n1 = baseTree.cachedSize();
+    size_t n2 = other.baseTree.cachedSize();
+    size_t repeated = 0;
+    runSetOp(other, pool, [&](Node* a, Node* b) {
+        return unionAVL(a, b, 0, repeated);
+    });
+    const size_t unknown = Base::UNKNOWN_SIZE;
+    baseTree.setSize((n1 == unknown || n2 == unknown) ? unknown : n1 + n2 - repeated);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::intersect_with(AVLTree& other, workStealingPool& pool) {
+    if (&other == this) return;
+    size_t common = 0;
+    runSetOp(other, pool, [&](Node* a, Node* b) {
+        return intersectAVL(a, b, 0, common);
+    });
+    baseTree.setSize(common);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::difference_with(AVLTree& other, workStealingPool& pool) {
+    if (&other == this) {
+        baseTree.clear();
+        return;
+    }
+    size_t n1 = baseTree.cachedSize();
+    size_t removed = 0;
+    runSetOp(other, pool, [&](Node* a, Node* b) {
+        return differenceAVL(a, b, 0, removed);
+    });
+    baseTree.setSize(n1 == Base::UNKNOWN_SIZE ? n1 : n1 - removed);
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+frozenTree<T, B> AVLTree<T, B, Backend, Stats>::freeze() const {
+    return baseTree.freeze();
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::inorderTraversal(Node* node) {
     if (node != nullptr) {
-#ifdef USE_LEAF_TREE
-        if (node->leaf) {
-            std::cout << "(" << node->key << ", " << node->val << ") ";
+        if constexpr (Backend::leaf) {
+            if (node->leaf) {
+                std::cout << "(" << node->key << ", " << node->val << ") ";
+            } else {
+                inorderTraversal(node->left);
+                inorderTraversal(node->right);
+            }
         } else {
             inorderTraversal(node->left);
+            std::cout << "(" << node->key << ", " << node->val << ") ";
             inorderTraversal(node->right);
         }
-#else
-        inorderTraversal(node->left);
-        std::cout << "(" << node->key << ", " << node->val << ") ";
-        inorderTraversal(node->right);
-#endif
     }
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::preorderTraversal(AVL_NODE<T, B>* node) {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::preorderTraversal(Node* node) {
     if (node != nullptr) {
-#ifdef USE_LEAF_TREE
-        if (node->leaf) {
-            std::cout << "(" << node->key << ", " << node->val << ") ";
+        if constexpr (Backend::leaf) {
+            if (node->leaf) {
+                std::cout << "(" << node->key << ", " << node->val << ") ";
+            } else {
+                preorderTraversal(node->left);
+                preorderTraversal(node->right);
+            }
         } else {
+            std::cout << "(" << node->key << ", " << node->val << ") ";
             preorderTraversal(node->left);
             preorderTraversal(node->right);
         }
-#else
-        std::cout << "(" << node->key << ", " << node->val << ") ";
-        preorderTraversal(node->left);
-        preorderTraversal(node->right);
-#endif
     }
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::postorderTraversal(AVL_NODE<T, B>* node) {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::postorderTraversal(Node* node) {
     if (node != nullptr) {
-#ifdef USE_LEAF_TREE
-        if (node->leaf) {
-            std::cout << "(" << node->key << ", " << node->val << ") ";
+        if constexpr (Backend::leaf) {
+            if (node->leaf) {
+                std::cout << "(" << node->key << ", " << node->val << ") ";
+            } else {
+                postorderTraversal(node->left);
+                postorderTraversal(node->right);
+            }
         } else {
             postorderTraversal(node->left);
             postorderTraversal(node->right);
+            std::cout << "(" << node->key << ", " << node->val << ") ";
         }
-#else
-        postorderTraversal(node->left);
-        postorderTraversal(node->right);
-        std::cout << "(" << node->key << ", " << node->val << ") ";
-#endif
     }
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::printInorder() {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::printInorder() {
     std::cout << "Inorder: ";
     // Usar getRoot() en lugar de acceso directo a baseTree.root
     inorderTraversal(baseTree.getRoot());
     std::cout << std::endl;
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::printPreorder() {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::printPreorder() {
     std::cout << "Preorder: ";
     // Usar getRoot() en lugar de acceso directo a baseTree.root
     preorderTraversal(baseTree.getRoot());
     std::cout << std::endl;
 }
 
-template<typename T, typename B>
-void AVLTree<T, B>::printPostorder() {
+template<typename T, typename B, typename Backend, typename Stats>
+void AVLTree<T, B, Backend, Stats>::printPostorder() {
     std::cout << "Postorder: ";
     // Usar getRoot() en lugar de acceso directo a baseTree.root
     postorderTraversal(baseTree.getRoot());
     std::cout << std::endl;
 }
 
-template<typename T, typename B>
-bool AVLTree<T, B>::isBalanced() {
+template<typename T, typename B, typename Backend, typename Stats>
+bool AVLTree<T, B, Backend, Stats>::isBalanced() {
     // Usar getRoot() en lugar de acceso directo a baseTree.root
     return std::abs(getBalance(baseTree.getRoot())) <= 1;
 }
 
-template<typename T, typename B>
-int AVLTree<T, B>::getTreeHeight() {
+template<typename T, typename B, typename Backend, typename Stats>
+int AVLTree<T, B, Backend, Stats>::getTreeHeight() {
     // Usar getRoot() en lugar de acceso directo a baseTree.root
     return getHeight(baseTree.getRoot());
 }
 
+// Estadísticas de orden (withRank)
+
+// Baja como una búsqueda y, cada vez que va a la derecha, suma lo que deja a
+// la izquierda. inclusive: cuenta también las claves iguales a key.
+template<typename T, typename B, typename Backend, typename Stats>
+size_t AVLTree<T, B, Backend, Stats>::countBefore(const T& key, bool inclusive) const requires Backend::ranked {
+    size_t before = 0;
+    Node* n = baseTree.getRoot();
+    while (n != nullptr) {
+        bool right = inclusive ? !(key < n->key) : n->key < key;
+        if constexpr (Backend::leaf) {
+            // Hojas: la propia clave. Internos: todo el subárbol izquierdo
+            // es menor que n->key y el derecho no
+            if (n->leaf) return before + right;
+            if (right) before += getCount(n->left);
+        } else {
+            if (right) before += getCount(n->left) + 1;
+        }
+        n = right ? n->right : n->left;
+    }
+    return before;
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+typename AVLTree<T, B, Backend, Stats>::Node* AVLTree<T, B, Backend, Stats>::select(size_t k) const requires Backend::ranked {
+    Node* n = baseTree.getRoot();
+    if (k >= getCount(n)) return nullptr;
+    while (true) {
+        size_t left = getCount(n->left);
+        if constexpr (Backend::leaf) {
+            if (n->leaf) return n;
+        } else {
+            if (k == left) return n;
+        }
+        if (k < left) {
+            n = n->left;
+        } else {
+            k -= left + (Backend::leaf ? 0 : 1);
+            n = n->right;
+        }
+    }
+}
+
+template<typename T, typename B, typename Backend, typename Stats>
+size_t AVLTree<T, B, Backend, Stats>::count_range(const T& lo, const T& hi) const requires Backend::ranked {
+    if (hi < lo) return 0;
+    return countBefore(hi, true) - countBefore(lo, false);
+}
+
+// Lo del backend más lo que el AVL añade alrededor (contexto de conjuntos)
+template<typename T, typename B, typename Backend, typename Stats>
+memoryUsage AVLTree<T, B, Backend, Stats>::memory_usage() const {
+    memoryUsage m = baseTree.memory_usage();
+    m.overheadBytes += sizeof(*this) - sizeof(baseTree);
+    return m;
+}
+
 #endif // AVL_TREE_H
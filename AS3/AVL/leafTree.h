@@ -2,70 +2,219 @@
 #define LEAFTREE_H
 
 #include <iostream>
-
-template<typename T, typename B>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../common/nodePool.h"
+#include "../common/frozenTree.h"
+#include "../common/memoryUsage.h"
+#include "../common/subtreeCount.h"
+
+// Ranked: cada nodo guarda además cuántas hojas tiene su subárbol (ver AVLTree)
+template<typename T, typename B, bool Ranked = false>
 class node {
   public:
     T key;
     B val;
     node* left;
     node* right;
+    int height;
     bool leaf;
+    [[no_unique_address]] subtreeCount<Ranked> count;
     node(T nkey, B nval, node* nleft = nullptr, node* nright = nullptr, bool nleaf = false);
 };
 
-template<typename T, typename B>
+// El tipo de nodo es el del asignador: node<T, B> o node<T, B, true>
+template<typename T, typename B, typename Alloc = nodePool<node<T,B>>>
 class leafTree {
-    node<T,B>* root;
-    size_t size;
+  public:
+    typedef typename Alloc::node_type Node;
+
+  private:
+    Node* root;
+    mutable size_t size;
+    // Sólo este árbol reserva y libera en su pool, así que árboles distintos
+    // (p. ej. las dos mitades de un split) pueden usarse desde hilos
+    // distintos. Un árbol movido se queda sin pool (así mover no reserva) y
+    // lo crea pool() al insertar.
+    std::shared_ptr<Alloc> alloc;
+    // Pools de otros árboles en cuyos slabs quedan nodos de este (tras un
+    // split o al adoptar un pool que otro también guarda). Sólo se mantienen
+    // vivos: los nodos que se liberan van a la lista libre de alloc.
+    std::vector<std::shared_ptr<Alloc>> borrowed;
+
+    Alloc& pool() { if (!alloc) alloc = std::make_shared<Alloc>(); return *alloc; }
+    void borrow(const std::shared_ptr<Alloc>& p) {
+        if (p && p != alloc && std::find(borrowed.begin(), borrowed.end(), p) == borrowed.end())
+            borrowed.push_back(p);
+    }
 
   public:
-    leafTree(node<T,B>* nnode = nullptr);
-    node<T, B>* deleteNode(T key);
-    node<T, B>* find(T key);
-    node<T, B>* insert(T key, B val);
-    node<T, B>*& getRootRef() { return root; }
-    node<T, B>* getRoot() const { return root; }
-    void setRoot(node<T, B>* newRoot) { root = newRoot; }
-    size_t getSize() const { return size; }
+    // Tamaño pendiente de contar (tras un split); getSize lo recalcula
+    static constexpr size_t UNKNOWN_SIZE = size_t(-1);
+
+    leafTree();
+    ~leafTree();
+    leafTree(const leafTree&) = delete;
+    leafTree& operator=(const leafTree&) = delete;
+    leafTree(leafTree&& other) noexcept;
+    leafTree& operator=(leafTree&& other) noexcept;
+    Node* deleteNode(T key);
+    Node* find(T key);
+    Node* insert(T key, B val);
+    Node*& getRootRef() { return root; }
+    Node* getRoot() const { return root; }
+    void setRoot(Node* newRoot) { root = newRoot; }
+    size_t getSize() const;
+    size_t cachedSize() const { return size; } // sin recontar: puede ser UNKNOWN_SIZE
     void setSize(size_t newSize) { size = newSize; }
-    void incrementSize() { size++; }
-    void decrementSize() { if (size > 0) size--; }
+    void incrementSize() { if (size != UNKNOWN_SIZE) size++; }
+    void decrementSize() { if (size > 0 && size != UNKNOWN_SIZE) size--; }
+    void clear() { destroyTree(root); root = nullptr; size = 0; }
+
+    // Instantánea de sólo lectura (sólo hojas) en orden de Eytzinger, O(n)
+    frozenTree<T, B> freeze() const;
+
+    // Acceso al asignador para los árboles construidos encima (AVL)
+    template<typename... Args>
+    Node* createNode(Args&&... args) { return pool().create(std::forward<Args>(args)...); }
+    void destroyNode(Node* n) { pool().destroy(n); }
+
+    // Se queda con los nodos de other (que queda vacío) y devuelve su raíz
+    Node* adopt(leafTree& other);
+    // Vacía el árbol para recibir nodos de other, que siguen en sus slabs:
+    // los pools de other se mantienen vivos, pero éste reserva en el suyo
+    void borrowPools(const leafTree& other);
+
+    // Liberación y reserva desde varios hilos sin tocar el pool (ver nodePool)
+    typedef typename Alloc::chain retireChain;
+    void retireNode(retireChain& c, Node* n) { Alloc::retire(c, n); }
+    template<typename... Args>
+    Node* reuseNode(retireChain& c, Args&&... args) { return Alloc::reuse(c, std::forward<Args>(args)...); }
+    void reclaim(retireChain& c) { pool().reclaim(c); }
+
+    // Nodos contados por estructura (getSize); los slabs de los pools
+    // prestados se cuentan enteros, también en cada mitad de un split
+    memoryUsage memory_usage() const;
 
   private:
-    node<T, B>* findNode(T key);
-    node<T, B>* findParent(T key, node<T, B>* actual, node<T, B>* parent);
-    node<T, B>* findNode(T key, node<T, B>* actual);
-    node<T, B>* find(T key, node<T, B>* actual);
+    Node* findNode(T key);
+    Node* findParent(T key, Node* actual, Node* parent);
+    Node* findNode(T key, Node* actual);
+    Node* find(T key, Node* actual);
+    void destroyTree(Node* actual);
+    size_t countLeaves(Node* actual) const;
+    void collectLeaves(Node* actual, std::vector<T>& keys, std::vector<B>& vals) const;
 };
 
-template<typename T, typename B>
-node<T,B>::node(T nkey, B nval, node* nleft, node* nright, bool nleaf) : 
-key(nkey), val(nval), left(nleft), right(nright), leaf(nleaf) {}
+template<typename T, typename B, bool Ranked>
+node<T,B,Ranked>::node(T nkey, B nval, node* nleft, node* nright, bool nleaf) : 
+key(nkey), val(nval), left(nleft), right(nright), height(1), leaf(nleaf), count(1) {}
+
+template<typename T, typename B, typename Alloc>
+leafTree<T,B,Alloc>::leafTree() : root(nullptr), size(0), alloc(std::make_shared<Alloc>()) {}
+
+template<typename T, typename B, typename Alloc>
+leafTree<T,B,Alloc>::leafTree(leafTree&& other) noexcept
+  : root(other.root), size(other.size), alloc(std::move(other.alloc)),
+    borrowed(std::move(other.borrowed))
+{
+  other.root = nullptr;
+  other.size = 0;
+}
+
+template<typename T, typename B, typename Alloc>
+leafTree<T,B,Alloc>& leafTree<T,B,Alloc>::operator=(leafTree&& other) noexcept
+{
+  if (this != &other) {
+    clear();
+    std::swap(root, other.root);
+    std::swap(size, other.size);
+    std::swap(alloc, other.alloc);
+    std::swap(borrowed, other.borrowed);
+  }
+  return *this;
+}
+
+// Con nodos triviales basta con soltar los slabs (ver nodeTree)
+template<typename T, typename B, typename Alloc>
+leafTree<T,B,Alloc>::~leafTree() {
+  if (!Alloc::bulkRelease || !std::is_trivially_destructible<Node>::value) {
+    destroyTree(root);
+  }
+}
+
+template<typename T, typename B, typename Alloc>
+void leafTree<T,B,Alloc>::destroyTree(Node* actual) 
+{
+  if (actual != nullptr) {
+    destroyTree(actual->left);
+    destroyTree(actual->right);
+    pool().destroy(actual);
+  }
+}
+
+template<typename T, typename B, typename Alloc>
+size_t leafTree<T,B,Alloc>::getSize() const
+{
+  if (size == UNKNOWN_SIZE) size = countLeaves(root);
+  return size;
+}
+
+template<typename T, typename B, typename Alloc>
+size_t leafTree<T,B,Alloc>::countLeaves(Node* actual) const
+{
+  if (actual == nullptr) return 0;
+  if (actual->left == nullptr && actual->right == nullptr) return 1;
+  return countLeaves(actual->left) + countLeaves(actual->right);
+}
+
+// Si nadie más guarda el pool de other sus slabs pasan a este, O(número de
+// slabs); si no, basta con mantenerlo vivo, O(1). En ambos casos este árbol
+// se queda también con los pools que other tenía prestados.
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::adopt(leafTree& other)
+{
+  Node* adopted = other.root;
+  if (other.alloc && alloc != other.alloc) {
+    if (other.alloc.use_count() == 1) pool().splice(*other.alloc);
+    else borrow(other.alloc);
+  }
+  for (const auto& p : other.borrowed) borrow(p);
+  other.root = nullptr;
+  other.size = 0;
+  return adopted;
+}
 
-template<typename T, typename B>
-leafTree<T,B>::leafTree(node<T,B>* nnode) : root(nnode), size(nnode ? 1 : 0) {}
+template<typename T, typename B, typename Alloc>
+void leafTree<T,B,Alloc>::borrowPools(const leafTree& other)
+{
+  clear();
+  for (const auto& p : other.borrowed) borrow(p);
+  borrow(other.alloc);
+}
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findNode(T key) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::findNode(T key) 
 { 
   return findNode(key, root); 
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::insert(T key, B val) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::insert(T key, B val) 
 {
   if (root == nullptr) {
-    root = new node<T, B>(key, val);
-    size++;
+    root = pool().create(key, val);
+    incrementSize();
     return root;
   }
 
-  node<T, B>* parent = findNode(key);
+  Node* parent = findNode(key);
   if (!parent) return nullptr;
 
-  node<T, B>* old_node = new node<T,B>(parent->key, parent->val);
-  node<T, B>* new_node = new node<T,B>(key, val);
+  Node* old_node = pool().create(parent->key, parent->val);
+  Node* new_node = pool().create(key, val);
 
   if (parent->key < key) {
     parent->key = key;
@@ -75,7 +224,7 @@ node<T, B>* leafTree<T,B>::insert(T key, B val)
     parent->right = old_node;
     parent->left = new_node;
   }
-  size++;
+  incrementSize();
 
   parent->leaf = false;
   old_node->leaf = true;
@@ -84,8 +233,8 @@ node<T, B>* leafTree<T,B>::insert(T key, B val)
   return new_node;
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findNode(T key, node<T, B>* actual) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::findNode(T key, Node* actual) 
 {
   if (actual == nullptr)
     return nullptr;
@@ -101,18 +250,18 @@ node<T, B>* leafTree<T,B>::findNode(T key, node<T, B>* actual)
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::find(T key) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::find(T key) 
 {
-  node<T, B>* result = find(key, root);
-  if (result->key == key) {
+  Node* result = find(key, root);
+  if (result && result->key == key) {
     return result;
   }
   return nullptr;
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::find(T key, node<T, B>* actual) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::find(T key, Node* actual) 
 {
   if (actual == nullptr)
     return nullptr;
@@ -130,8 +279,8 @@ node<T, B>* leafTree<T,B>::find(T key, node<T, B>* actual)
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findParent(T key, node<T, B>* actual, node<T, B>* parent) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::findParent(T key, Node* actual, Node* parent) 
 {
   if (actual == nullptr)
     return nullptr;
@@ -151,8 +300,8 @@ node<T, B>* leafTree<T,B>::findParent(T key, node<T, B>* actual, node<T, B>* par
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::deleteNode(T key) 
+template<typename T, typename B, typename Alloc>
+typename leafTree<T,B,Alloc>::Node* leafTree<T,B,Alloc>::deleteNode(T key) 
 {
   if (root == nullptr) {
     return nullptr;
@@ -161,19 +310,17 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
   // Caso especial: árbol con un solo nodo
   if (root->left == nullptr && root->right == nullptr) {
     if (root->key == key) {
-      node<T, B>* deleted = root;
+      pool().destroy(root);
       root = nullptr;
-      size--;
-      return deleted;
-    } else {
-      return nullptr;
+      decrementSize();
     }
+    return root;
   }
 
   // Variables para navegar
-  node<T, B>* tmp_node = root;
-  node<T, B>* upper_node = nullptr;
-  node<T, B>* other_node = nullptr;
+  Node* tmp_node = root;
+  Node* upper_node = nullptr;
+  Node* other_node = nullptr;
 
   // Navegar hasta encontrar el nodo hoja
   while (tmp_node->right != nullptr) {
@@ -189,7 +336,7 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
 
   // Verificar si encontramos el nodo a eliminar
   if (tmp_node->key != key) {
-    return nullptr;
+    return root;
   }
 
   // El nodo padre (upper_node) absorbe al hermano (other_node)
@@ -199,11 +346,51 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
   upper_node->right = other_node->right;
   upper_node->leaf = other_node->leaf;
 
-  node<T, B>* deleted_object = tmp_node;
-  delete other_node;
-  size--;
+  pool().destroy(tmp_node);
+  pool().destroy(other_node);
+  decrementSize();
+
+  return root;
+}
+
+template<typename T, typename B, typename Alloc>
+frozenTree<T, B> leafTree<T,B,Alloc>::freeze() const
+{
+  std::vector<T> keys;
+  std::vector<B> vals;
+  keys.reserve(getSize());
+  vals.reserve(getSize());
+  collectLeaves(root, keys, vals);
+  return frozenTree<T, B>(keys, vals);
+}
 
-  return deleted_object;
+template<typename T, typename B, typename Alloc>
+void leafTree<T,B,Alloc>::collectLeaves(Node* actual, std::vector<T>& keys, std::vector<B>& vals) const
+{
+  if (actual == nullptr) return;
+  if (actual->left == nullptr && actual->right == nullptr) {
+    keys.push_back(actual->key);
+    vals.push_back(actual->val);
+    return;
+  }
+  collectLeaves(actual->left, keys, vals);
+  collectLeaves(actual->right, keys, vals);
+}
+
+template<typename T, typename B, typename Alloc>
+memoryUsage leafTree<T,B,Alloc>::memory_usage() const
+{
+  memoryUsage m;
+  m.leafNodes = getSize();
+  m.internalNodes = m.leafNodes > 0 ? m.leafNodes - 1 : 0;
+  m.nodeBytes = (m.leafNodes + m.internalNodes) * sizeof(Node);
+  // nodes * blockBytes son los bloques de heapAlloc; los slabs de nodePool
+  // están en reservedBytes
+  size_t reserved = (m.leafNodes + m.internalNodes) * Alloc::blockBytes;
+  if (alloc) reserved += alloc->reservedBytes() + sizeof(Alloc);
+  for (const auto& p : borrowed) reserved += p->reservedBytes() + sizeof(Alloc);
+  m.overheadBytes = reserved - m.nodeBytes + borrowed.capacity() * sizeof(borrowed[0]) + sizeof(*this);
+  return m;
 }
 
 #endif
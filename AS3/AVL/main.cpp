@@ -1,21 +1,34 @@
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <ctime>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <type_traits>
+#include "../common/workload.h"
+#include "avl.h"
 
-// #define USE_LEAF_TREE
+// Los dos backends en el mismo binario:
+//   g++ -O2 -std=c++20 -pthread main.cpp -o avl
 
-#include "avl.h"
+// Sin noexcept std::vector copiaría los árboles al crecer en vez de moverlos
+static_assert(std::is_nothrow_move_constructible_v<AVLTree<int, int, nodeBackend>>);
+static_assert(std::is_nothrow_move_constructible_v<AVLTree<int, int, leafBackend>>);
 
+template<typename Backend>
+const char* backendName() {
+  if (Backend::ranked) return Backend::leaf ? "leafTree+rank" : "nodeTree+rank";
+  return Backend::leaf ? "leafTree" : "nodeTree";
+}
+
+template<typename Backend>
 void testAVLTree() {
   std::cout << "=== Testing AVL Tree Implementation ===" << std::endl;
+  std::cout << "Using " << backendName<Backend>() << " backend" << std::endl;
 
-#ifdef USE_LEAF_TREE
-  std::cout << "Using LEAF TREE implementation" << std::endl;
-#else
-  std::cout << "Using NODE TREE implementation" << std::endl;
-#endif
-
-  AVLTree<int, std::string> avl;
+  AVLTree<int, std::string, Backend> avl;
 
   std::cout << "\n1. Inserting elements..." << std::endl;
 
@@ -87,10 +100,11 @@ void testAVLTree() {
   avl.printInorder();
 }
 
+template<typename Backend>
 void stressTest() {
-  std::cout << "\n=== Stress Test ===" << std::endl;
+  std::cout << "\n=== Stress Test (" << backendName<Backend>() << ") ===" << std::endl;
 
-  AVLTree<int, int> avl;
+  AVLTree<int, int, Backend> avl;
 
   // Insert sequential numbers (worst case for regular BST)
   std::cout << "Inserting sequential numbers 1-15..." << std::endl;
@@ -113,18 +127,181 @@ void stressTest() {
   avl.printInorder();
 }
 
-int main() {
-  //testAVLTree();
-  //stressTest();
-  AVLTree<int, int> avl;
-  clock_t before = clock();
-  for (int i = 0; i < 1e5; i++) {
-    avl.insert(i, i);
+// Benchmark de 1e6 claves con un backend
+template<typename Backend>
+void benchmark(int n) {
+  typedef AVLTree<int, int, Backend> Tree;
+  std::cout << "Backend: " << backendName<Backend>() << ", n = " << n << std::endl;
+
+  workload wl;
+  std::vector<int> keys = wl.keys(n, keyOrder::sequential);
+
+  {
+    Tree avl;
+    clock_t before = clock();
+    for (int k : keys) avl.insert(k, k);
+    clock_t duration = clock() - before;
+    std::cout << "Sequential insert: " << (float)duration / CLOCKS_PER_SEC << " seconds, height " << avl.getTreeHeight() << std::endl;
   }
+
+  {
+    std::vector<std::pair<int, int>> sorted;
+    sorted.reserve(n);
+    for (int k : keys) sorted.emplace_back(k, k);
+    Tree avl;
+    clock_t before = clock();
+    avl.build_from_sorted(sorted.begin(), sorted.end());
+    clock_t duration = clock() - before;
+    std::cout << "Bulk load:         " << (float)duration / CLOCKS_PER_SEC << " seconds, height " << avl.getTreeHeight() << std::endl;
+  }
+
+  keys = wl.keys(n, keyOrder::uniform, 0);
+  Tree avl;
+  clock_t before = clock();
+  for (int k : keys) avl.insert(k, k);
   clock_t duration = clock() - before;
+  std::cout << "Random insert:     " << (float)duration / CLOCKS_PER_SEC << " seconds, height " << avl.getTreeHeight() << std::endl;
 
-  std::cout << "Duration: " << (float)duration / CLOCKS_PER_SEC << " seconds";
+  keys = wl.keys(n, keyOrder::uniform, 1);
+  long long found = 0;
+  before = clock();
+  for (int k : keys) found += avl.find(k) != nullptr;
+  duration = clock() - before;
+  std::cout << "Random find:       " << (float)duration / CLOCKS_PER_SEC << " seconds (" << found << " found)" << std::endl;
 
+  // Partir por una clave y volver a unir: el elemento de corte pasa a ser el separador
+  const int rounds = 10000;
+  before = clock();
+  for (int i = 0; i < rounds; i++) {
+    int k = keys[i];
+    auto halves = avl.split(k);
+    halves.second.deleteNode(k);
+    avl = Tree::join(std::move(halves.first), k, k, std::move(halves.second));
+  }
+  duration = clock() - before;
+  std::cout << "Split + join:      " << (float)duration / CLOCKS_PER_SEC << " seconds (" << rounds << " rounds), height " << avl.getTreeHeight() << std::endl;
+
+  keys = wl.keys(n, keyOrder::uniform, 2);
+  before = clock();
+  for (int k : keys) avl.deleteNode(k);
+  duration = clock() - before;
+  std::cout << "Random delete:     " << (float)duration / CLOCKS_PER_SEC << " seconds" << std::endl;
+}
+
+// Inserción y borrado iterativos frente a los recursivos originales:
+// ns por operación y rotaciones simples por operación
+template<typename Backend, typename Insert, typename Delete>
+void timeVariant(const char* order, const char* variant, const std::vector<int>& insertKeys,
+                 const std::vector<int>& deleteKeys, Insert ins, Delete del) {
+  AVLTree<int, int, Backend> avl;
+  double n = insertKeys.size();
+  clock_t before = clock();
+  for (int k : insertKeys) ins(avl, k);
+  double insertNs = (double)(clock() - before) / CLOCKS_PER_SEC * 1e9 / n;
+  double insertRot = avl.getRotations() / n;
+
+  avl.resetRotations();
+  before = clock();
+  for (int k : deleteKeys) del(avl, k);
+  double deleteNs = (double)(clock() - before) / CLOCKS_PER_SEC * 1e9 / n;
+  double deleteRot = avl.getRotations() / n;
+
+  std::printf("%-12s%-11s%12.1f%12.3f%12.1f%12.3f\n", order, variant, insertNs, insertRot, deleteNs, deleteRot);
+}
+
+template<typename Backend>
+void compareIterative(int n) {
+  typedef AVLTree<int, int, Backend> Tree;
+  std::cout << "\nIterative vs recursive, backend " << backendName<Backend>() << std::endl;
+  workload wl;
+  std::vector<int> randomDelete = wl.keys(n, keyOrder::uniform, 1);
+  auto insIter = [](Tree& t, int k) { t.insert(k, k); };
+  auto delIter = [](Tree& t, int k) { t.deleteNode(k); };
+  auto insRec = [](Tree& t, int k) { t.insertRecursive(k, k); };
+  auto delRec = [](Tree& t, int k) { t.deleteRecursive(k); };
+
+  // Se borra en el mismo orden en que se insertó, salvo con uniform
+  std::printf("%-12s%-11s%12s%12s%12s%12s\n", "order", "variant", "insert ns", "rot/ins", "delete ns", "rot/del");
+  for (const char* name : {"sequential", "reverse", "clustered", "adversarial", "uniform"}) {
+    keyOrder order = workload::parseOrder(name);
+    std::vector<int> keys = wl.keys(n, order);
+    const std::vector<int>& deleteKeys = order == keyOrder::uniform ? randomDelete : keys;
+    timeVariant<Backend>(name, "recursive", keys, deleteKeys, insRec, delRec);
+    timeVariant<Backend>(name, "iterative", keys, deleteKeys, insIter, delIter);
+  }
+}
+
+// select/rank/count_range de withRank frente a contarlos recorriendo las
+// claves en orden (std::map: next, distance), y lo que cuesta mantener los
+// tamaños al insertar. ns por operación.
+static volatile long long rankSink; // que no se quiten las consultas
+
+template<typename Backend>
+void compareRank(int n) {
+  std::cout << "\nOrder statistics, backend " << backendName<withRank<Backend>>() << ", n = " << n << std::endl;
+  workload wl;
+  std::vector<int> keys = wl.keys(n, keyOrder::uniform, 0);
+  std::vector<int> queries = wl.keys(n, keyOrder::uniform, 1);
+  const int linearQueries = 20;
+
+  AVLTree<int, int, Backend> plain;
+  AVLTree<int, int, withRank<Backend>> ranked;
+  clock_t before = clock();
+  for (int k : keys) plain.insert(k, k);
+  double plainNs = (double)(clock() - before) / CLOCKS_PER_SEC * 1e9 / n;
+  before = clock();
+  for (int k : keys) ranked.insert(k, k);
+  double rankedNs = (double)(clock() - before) / CLOCKS_PER_SEC * 1e9 / n;
+  std::printf("%-14s%12s%12s\n", "", "plain ns", "ranked ns");
+  std::printf("%-14s%12.1f%12.1f\n", "insert", plainNs, rankedNs);
+
+  std::map<int, int> ordered;
+  for (int k : keys) ordered.emplace(k, k);
+
+  auto time = [](int count, auto op) {
+    long long sink = 0;
+    clock_t start = clock();
+    for (int i = 0; i < count; i++) sink += op(i);
+    double ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / count;
+    rankSink = sink;
+    return std::make_pair(ns, sink);
+  };
+  // El recorrido sólo con linearQueries consultas; el árbol con todas, y las
+  // primeras se comparan para ver que dan lo mismo
+  auto compare = [&](const char* name, auto scan, auto tree) {
+    auto slow = time(linearQueries, scan);
+    bool same = slow.second == time(linearQueries, tree).second;
+    double fast = time(n - 1, tree).first;
+    std::printf("%-14s%12.1f%12.1f%10.0fx%s\n", name, slow.first, fast, slow.first / fast, same ? "" : "  (distintos!)");
+  };
+
+  std::printf("%-14s%12s%12s%11s\n", "", "scan ns", "rank ns", "speedup");
+  compare("select",
+          [&](int i) { return (long long)std::next(ordered.begin(), queries[i] % n)->first; },
+          [&](int i) { return (long long)ranked.select(queries[i] % n)->key; });
+  compare("rank",
+          [&](int i) { return (long long)std::distance(ordered.begin(), ordered.lower_bound(queries[i])); },
+          [&](int i) { return (long long)ranked.rank(queries[i]); });
+  compare("count_range",
+          [&](int i) {
+            int lo = std::min(queries[i], queries[i + 1]), hi = std::max(queries[i], queries[i + 1]);
+            return (long long)std::distance(ordered.lower_bound(lo), ordered.upper_bound(hi));
+          },
+          [&](int i) {
+            int lo = std::min(queries[i], queries[i + 1]), hi = std::max(queries[i], queries[i + 1]);
+            return (long long)ranked.count_range(lo, hi);
+          });
+}
+
+int main() {
+  //testAVLTree<nodeBackend>();
+  //stressTest<leafBackend>();
+  benchmark<nodeBackend>(1000000);
+  benchmark<leafBackend>(1000000);
+  compareIterative<nodeBackend>(1000000);
+  compareIterative<leafBackend>(1000000);
+  compareRank<nodeBackend>(1000000);
+  compareRank<leafBackend>(1000000);
 
   return 0;
 }
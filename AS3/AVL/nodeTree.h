@@ -3,8 +3,17 @@
 
 #include <iostream>
 #include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../common/nodePool.h"
+#include "../common/frozenTree.h"
+#include "../common/memoryUsage.h"
+#include "../common/subtreeCount.h"
 
-template<typename T, typename B>
+// Ranked: cada nodo guarda además el tamaño de su subárbol (ver AVLTree)
+template<typename T, typename B, bool Ranked = false>
 class nodeT {
   public:
     T key;
@@ -12,76 +21,192 @@ class nodeT {
     nodeT* left;
     nodeT* right;
     int height;
+    [[no_unique_address]] subtreeCount<Ranked> count;
     
     nodeT(T nkey, B nval, nodeT* nleft = nullptr, nodeT* nright = nullptr) 
-        : key(nkey), val(nval), left(nleft), right(nright), height(1) {}
+        : key(nkey), val(nval), left(nleft), right(nright), height(1), count(1) {}
 };
 
-template<typename T, typename B>
+// El tipo de nodo es el del asignador: nodeT<T, B> o nodeT<T, B, true>
+template<typename T, typename B, typename Alloc = nodePool<nodeT<T,B>>>
 class nodeTree {
-    nodeT<T,B>* root;
-    size_t size;
+  public:
+    typedef typename Alloc::node_type Node;
+
+  private:
+    Node* root;
+    mutable size_t size;
+    // Sólo este árbol reserva y libera en su pool, así que árboles distintos
+    // (p. ej. las dos mitades de un split) pueden usarse desde hilos
+    // distintos. Un árbol movido se queda sin pool (así mover no reserva) y
+    // lo crea pool() al insertar.
+    std::shared_ptr<Alloc> alloc;
+    // Pools de otros árboles en cuyos slabs quedan nodos de este (tras un
+    // split o al adoptar un pool que otro también guarda). Sólo se mantienen
+    // vivos: los nodos que se liberan van a la lista libre de alloc.
+    std::vector<std::shared_ptr<Alloc>> borrowed;
+
+    Alloc& pool() { if (!alloc) alloc = std::make_shared<Alloc>(); return *alloc; }
+    void borrow(const std::shared_ptr<Alloc>& p) {
+        if (p && p != alloc && std::find(borrowed.begin(), borrowed.end(), p) == borrowed.end())
+            borrowed.push_back(p);
+    }
 
   public:
-    nodeTree(nodeT<T,B>* nnode = nullptr);
+    // Tamaño pendiente de contar (tras un split); getSize lo recalcula
+    static constexpr size_t UNKNOWN_SIZE = size_t(-1);
+
+    nodeTree();
     ~nodeTree();
+    nodeTree(const nodeTree&) = delete;
+    nodeTree& operator=(const nodeTree&) = delete;
+    nodeTree(nodeTree&& other) noexcept;
+    nodeTree& operator=(nodeTree&& other) noexcept;
     
-    nodeT<T, B>* insert(T key, B val);
-    nodeT<T, B>* find(T key);
-    nodeT<T, B>* deleteNode(T key);
+    Node* insert(T key, B val);
+    Node* find(T key);
+    Node* deleteNode(T key);
     
-    nodeT<T, B>* getMin();
-    nodeT<T, B>* getMax();
-    nodeT<T, B>*& getRootRef() { return root; }
-    nodeT<T, B>* getRoot() const { return root; }
-    void setRoot(nodeT<T, B>* newRoot) { root = newRoot; }
-    size_t getSize() const { return size; }
+    Node* getMin();
+    Node* getMax();
+    Node*& getRootRef() { return root; }
+    Node* getRoot() const { return root; }
+    void setRoot(Node* newRoot) { root = newRoot; }
+    size_t getSize() const;
+    size_t cachedSize() const { return size; } // sin recontar: puede ser UNKNOWN_SIZE
     void setSize(size_t newSize) { size = newSize; }
-    void incrementSize() { size++; }
-    void decrementSize() { if (size > 0) size--; }
+    void incrementSize() { if (size != UNKNOWN_SIZE) size++; }
+    void decrementSize() { if (size > 0 && size != UNKNOWN_SIZE) size--; }
+    void clear() { destroyTree(root); root = nullptr; size = 0; }
+    
+    // Instantánea de sólo lectura en orden de Eytzinger, O(n)
+    frozenTree<T, B> freeze() const;
+    
+    // Acceso al asignador para los árboles construidos encima (AVL)
+    template<typename... Args>
+    Node* createNode(Args&&... args) { return pool().create(std::forward<Args>(args)...); }
+    void destroyNode(Node* n) { pool().destroy(n); }
+    
+    // Se queda con los nodos de other (que queda vacío) y devuelve su raíz
+    Node* adopt(nodeTree& other);
+    // Vacía el árbol para recibir nodos de other, que siguen en sus slabs:
+    // los pools de other se mantienen vivos, pero éste reserva en el suyo
+    void borrowPools(const nodeTree& other);
+
+    // Liberación y reserva desde varios hilos sin tocar el pool (ver nodePool)
+    typedef typename Alloc::chain retireChain;
+    void retireNode(retireChain& c, Node* n) { Alloc::retire(c, n); }
+    template<typename... Args>
+    Node* reuseNode(retireChain& c, Args&&... args) { return Alloc::reuse(c, std::forward<Args>(args)...); }
+    void reclaim(retireChain& c) { pool().reclaim(c); }
+
+    // Nodos contados por estructura (getSize); los slabs de los pools
+    // prestados se cuentan enteros, también en cada mitad de un split
+    memoryUsage memory_usage() const;
 
   private:
-    nodeT<T, B>* insert(T key, B val, nodeT<T, B>* actual);
+    Node* insert(T key, B val, Node* actual);
     
-    nodeT<T, B>* find(T key, nodeT<T, B>* actual);
+    Node* find(T key, Node* actual);
     
-    nodeT<T, B>* deleteNode(T key, nodeT<T, B>* actual);
-    nodeT<T, B>* findMin(nodeT<T, B>* actual);
-    nodeT<T, B>* findMax(nodeT<T, B>* actual);
+    Node* deleteNode(T key, Node* actual);
+    Node* findMin(Node* actual);
+    Node* findMax(Node* actual);
     
-    void destroyTree(nodeT<T, B>* actual);
+    void destroyTree(Node* actual);
+    size_t countNodes(Node* actual) const;
+    void collectInorder(Node* actual, std::vector<T>& keys, std::vector<B>& vals) const;
 };
 
 
-template<typename T, typename B>
-nodeTree<T,B>::nodeTree(nodeT<T,B>* nnode) : root(nnode), size(nnode ? 1 : 0) {}
+template<typename T, typename B, typename Alloc>
+nodeTree<T,B,Alloc>::nodeTree() : root(nullptr), size(0), alloc(std::make_shared<Alloc>()) {}
+
+template<typename T, typename B, typename Alloc>
+nodeTree<T,B,Alloc>::nodeTree(nodeTree&& other) noexcept
+    : root(other.root), size(other.size), alloc(std::move(other.alloc)),
+      borrowed(std::move(other.borrowed)) {
+    other.root = nullptr;
+    other.size = 0;
+}
+
+template<typename T, typename B, typename Alloc>
+nodeTree<T,B,Alloc>& nodeTree<T,B,Alloc>::operator=(nodeTree&& other) noexcept {
+    if (this != &other) {
+        clear();
+        std::swap(root, other.root);
+        std::swap(size, other.size);
+        std::swap(alloc, other.alloc);
+        std::swap(borrowed, other.borrowed);
+    }
+    return *this;
+}
 
-template<typename T, typename B>
-nodeTree<T,B>::~nodeTree() {
-    destroyTree(root);
+// Con nodos triviales basta con soltar los slabs, sin recorrer el árbol;
+// los de un pool que otro árbol tenga prestado se liberan con el último
+template<typename T, typename B, typename Alloc>
+nodeTree<T,B,Alloc>::~nodeTree() {
+    if (!Alloc::bulkRelease || !std::is_trivially_destructible<Node>::value) {
+        destroyTree(root);
+    }
 }
 
-template<typename T, typename B>
-void nodeTree<T,B>::destroyTree(nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+void nodeTree<T,B,Alloc>::destroyTree(Node* actual) {
     if (actual != nullptr) {
         destroyTree(actual->left);
         destroyTree(actual->right);
-        delete actual;
+        pool().destroy(actual);
     }
 }
 
+template<typename T, typename B, typename Alloc>
+size_t nodeTree<T,B,Alloc>::getSize() const {
+    if (size == UNKNOWN_SIZE) size = countNodes(root);
+    return size;
+}
+
+template<typename T, typename B, typename Alloc>
+size_t nodeTree<T,B,Alloc>::countNodes(Node* actual) const {
+    if (actual == nullptr) return 0;
+    return 1 + countNodes(actual->left) + countNodes(actual->right);
+}
+
+// Si nadie más guarda el pool de other sus slabs pasan a este, O(número de
+// slabs); si no, basta con mantenerlo vivo, O(1). En ambos casos este árbol
+// se queda también con los pools que other tenía prestados.
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::adopt(nodeTree& other) {
+    Node* adopted = other.root;
+    if (other.alloc && alloc != other.alloc) {
+        if (other.alloc.use_count() == 1) pool().splice(*other.alloc);
+        else borrow(other.alloc);
+    }
+    for (const auto& p : other.borrowed) borrow(p);
+    other.root = nullptr;
+    other.size = 0;
+    return adopted;
+}
+
+template<typename T, typename B, typename Alloc>
+void nodeTree<T,B,Alloc>::borrowPools(const nodeTree& other) {
+    clear();
+    for (const auto& p : other.borrowed) borrow(p);
+    borrow(other.alloc);
+}
+
 // ============ INSERT ============
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::insert(T key, B val) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::insert(T key, B val) {
     root = insert(key, val, root);
     return root;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::insert(T key, B val, nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::insert(T key, B val, Node* actual) {
     if (actual == nullptr) {
-        size++;
-        return new nodeT<T, B>(key, val);
+        incrementSize();
+        return pool().create(key, val);
     }
     
     if (key == actual->key) {
@@ -99,13 +224,13 @@ nodeT<T, B>* nodeTree<T,B>::insert(T key, B val, nodeT<T, B>* actual) {
 }
 
 // ============ FIND ============
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::find(T key) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::find(T key) {
     return find(key, root);
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::find(T key, nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::find(T key, Node* actual) {
     if (actual == nullptr) {
         return nullptr;
     }
@@ -122,14 +247,14 @@ nodeT<T, B>* nodeTree<T,B>::find(T key, nodeT<T, B>* actual) {
 }
 
 // ============ DELETE ============
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::deleteNode(T key) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::deleteNode(T key) {
     root = deleteNode(key, root);
     return root;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::deleteNode(T key, nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::deleteNode(T key, Node* actual) {
     if (actual == nullptr) {
         return nullptr;
     }
@@ -140,29 +265,29 @@ nodeT<T, B>* nodeTree<T,B>::deleteNode(T key, nodeT<T, B>* actual) {
         actual->right = deleteNode(key, actual->right);
     } else {
         // Nodo encontrado - proceder a eliminar
-        size--;
+        decrementSize();
         
         // Caso 1: Nodo sin hijos (hoja)
         if (actual->left == nullptr && actual->right == nullptr) {
-            delete actual;
+            pool().destroy(actual);
             return nullptr;
         }
         
         // Caso 2: Nodo con un hijo
         if (actual->left == nullptr) {
-            nodeT<T, B>* temp = actual->right;
-            delete actual;
+            Node* temp = actual->right;
+            pool().destroy(actual);
             return temp;
         }
         if (actual->right == nullptr) {
-            nodeT<T, B>* temp = actual->left;
-            delete actual;
+            Node* temp = actual->left;
+            pool().destroy(actual);
             return temp;
         }
         
         // Caso 3: Nodo con dos hijos
         // Encontrar el sucesor inorder (mínimo del subárbol derecho)
-        nodeT<T, B>* successor = findMin(actual->right);
+        Node* successor = findMin(actual->right);
         
         // Copiar los datos del sucesor al nodo actual
         actual->key = successor->key;
@@ -170,14 +295,14 @@ nodeT<T, B>* nodeTree<T,B>::deleteNode(T key, nodeT<T, B>* actual) {
         
         // Eliminar el sucesor
         actual->right = deleteNode(successor->key, actual->right);
-        size++; // Compensar la decrementación extra
+        incrementSize(); // Compensar la decrementación extra
     }
     
     return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::findMin(nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::findMin(Node* actual) {
     if (actual == nullptr) {
         return nullptr;
     }
@@ -188,8 +313,8 @@ nodeT<T, B>* nodeTree<T,B>::findMin(nodeT<T, B>* actual) {
     return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::findMax(nodeT<T, B>* actual) {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::findMax(Node* actual) {
     if (actual == nullptr) {
         return nullptr;
     }
@@ -200,13 +325,48 @@ nodeT<T, B>* nodeTree<T,B>::findMax(nodeT<T, B>* actual) {
     return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::getMin() {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::getMin() {
     return findMin(root);
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::getMax() {
+template<typename T, typename B, typename Alloc>
+typename nodeTree<T,B,Alloc>::Node* nodeTree<T,B,Alloc>::getMax() {
     return findMax(root);
 }
+template<typename T, typename B, typename Alloc>
+frozenTree<T, B> nodeTree<T,B,Alloc>::freeze() const {
+    std::vector<T> keys;
+    std::vector<B> vals;
+    keys.reserve(getSize());
+    vals.reserve(getSize());
+    collectInorder(root, keys, vals);
+    return frozenTree<T, B>(keys, vals);
+}
+
+template<typename T, typename B, typename Alloc>
+void nodeTree<T,B,Alloc>::collectInorder(Node* actual, std::vector<T>& keys, std::vector<B>& vals) const {
+    if (actual != nullptr) {
+        collectInorder(actual->left, keys, vals);
+        keys.push_back(actual->key);
+        vals.push_back(actual->val);
+        collectInorder(actual->right, keys, vals);
+    }
+}
+
+template<typename T, typename B, typename Alloc>
+memoryUsage nodeTree<T,B,Alloc>::memory_usage() const
+{
+  memoryUsage m;
+  m.leafNodes = getSize();
+  m.nodeBytes = m.leafNodes * sizeof(Node);
+  // nodes * blockBytes son los bloques de heapAlloc; los slabs de nodePool
+  // están en reservedBytes
+  size_t reserved = (m.leafNodes + m.internalNodes) * Alloc::blockBytes;
+  if (alloc) reserved += alloc->reservedBytes() + sizeof(Alloc);
+  for (const auto& p : borrowed) reserved += p->reservedBytes() + sizeof(Alloc);
+  m.overheadBytes = reserved - m.nodeBytes + borrowed.capacity() * sizeof(borrowed[0]) + sizeof(*this);
+  return m;
+}
+
 #endif
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+#include "avl.h"
+
+// Los cuatro backends en el mismo binario:
+//   g++ -O2 -std=c++20 -pthread test.cpp -o test
+
+// Recorre el subárbol comprobando orden, alturas, balance y (con withRank)
+// tamaños, y deja los pares en orden en out. Devuelve la altura.
+template<typename Backend, typename Node>
+int checkNode(Node* n, std::vector<std::pair<int, int>>& out) {
+  if (n == nullptr) return 0;
+  if constexpr (Backend::leaf) {
+    if (n->leaf) {
+      assert(n->left == nullptr && n->right == nullptr && n->height == 1);
+      if constexpr (Backend::ranked) assert(n->count == 1);
+      out.push_back({n->key, n->val});
+      return 1;
+    }
+    // los internos tienen siempre dos hijos y enrutan: izquierda < key <= derecha
+    assert(n->left != nullptr && n->right != nullptr);
+  }
+  size_t before = out.size();
+  int hl = checkNode<Backend>(n->left, out);
+  size_t mid = out.size();
+  if constexpr (!Backend::leaf) out.push_back({n->key, n->val});
+  int hr = checkNode<Backend>(n->right, out);
+  if constexpr (Backend::leaf) {
+    assert(out[mid - 1].first < n->key && n->key <= out[mid].first);
+  } else {
+    assert(mid == before || out[mid - 1].first < n->key);
+    assert(mid + 1 == out.size() || n->key < out[mid + 1].first);
+  }
+  assert(hl - hr <= 1 && hr - hl <= 1);
+  assert(n->height == 1 + std::max(hl, hr));
+  if constexpr (Backend::ranked) assert(n->count == out.size() - before);
+  return n->height;
+}
+
+template<typename Backend>
+void check(AVLTree<int, int, Backend>& tree, const std::map<int, int>& ref) {
+  std::vector<std::pair<int, int>> pairs, expected(ref.begin(), ref.end());
+  int h = checkNode<Backend>(tree._test_root(), pairs);
+  assert(h == tree.getTreeHeight() && tree.isBalanced());
+  assert(tree.getSize() == ref.size());
+  assert(pairs == expected);
+  if constexpr (Backend::ranked) {
+    size_t i = 0;
+    for (auto [k, v] : ref) {
+      assert(tree.select(i)->key == k && tree.rank(k) == i);
+      i++;
+    }
+    assert(tree.select(ref.size()) == nullptr);
+    auto lo = ref.lower_bound(100), hi = ref.upper_bound(300);
+    assert(tree.count_range(100, 300) == size_t(std::distance(lo, hi)));
+  }
+}
+
+unsigned seed = 12345;
+int next(int range) {
+  seed = seed * 1103515245 + 12345;
+  return int(seed >> 8) % range;
+}
+
+template<typename Backend>
+void testBackend() {
+  using Tree = AVLTree<int, int, Backend>;
+  Tree tree;
+  std::map<int, int> ref;
+
+  // inserciones y borrados mezclados, iterativos y recursivos
+  for (int i = 0; i < 3000; i++) {
+    int k = next(500);
+    switch (next(4)) {
+      case 0: tree.insert(k, i); ref[k] = i; break;
+      case 1: tree.insertRecursive(k, i); ref[k] = i; break;
+      case 2: tree.deleteNode(k); ref.erase(k); break;
+      case 3: tree.deleteRecursive(k); ref.erase(k); break;
+    }
+    check(tree, ref);
+    auto n = tree.find(k);
+    assert((n != nullptr) == ref.contains(k));
+    if (n) assert(n->val == ref[k]);
+  }
+
+  // split y join: se parte por una clave, se quita de la derecha y se vuelve
+  // a unir con ella en medio
+  for (int i = 0; i < 50; i++) {
+    int k = next(500);
+    auto [l, r] = tree.split(k);
+    std::map<int, int> refL(ref.begin(), ref.lower_bound(k)), refR(ref.lower_bound(k), ref.end());
+    check(tree, {});
+    check(l, refL);
+    check(r, refR);
+    r.deleteNode(k);
+    refR.erase(k);
+    check(r, refR);
+    tree = Tree::join(std::move(l), k, -i, std::move(r));
+    ref[k] = -i;
+    check(tree, ref);
+  }
+
+  // conjuntos contra árboles aleatorios; other queda vacío
+  for (int i = 0; i < 30; i++) {
+    Tree other;
+    std::map<int, int> refO;
+    for (int j = next(400); j > 0; j--) {
+      int k = next(500);
+      other.insert(k, 1000 + j);
+      refO[k] = 1000 + j;
+    }
+    switch (i % 3) {
+      case 0:
+        tree.union_with(other);
+        for (auto [k, v] : refO) ref[k] = v;
+        break;
+      case 1:
+        tree.intersect_with(other);
+        std::erase_if(ref, [&](auto& p) { return !refO.contains(p.first); });
+        break;
+      case 2:
+        tree.difference_with(other);
+        std::erase_if(ref, [&](auto& p) { return refO.contains(p.first); });
+        break;
+    }
+    check(tree, ref);
+    check(other, {});
+    if (ref.size() < 100) {
+      for (int j = 0; j < 300; j++) {
+        int k = next(500);
+        tree.insert(k, j);
+        ref[k] = j;
+      }
+      check(tree, ref);
+    }
+  }
+
+  // consigo mismo
+  tree.union_with(tree);
+  tree.intersect_with(tree);
+  check(tree, ref);
+  tree.difference_with(tree);
+  ref.clear();
+  check(tree, ref);
+
+  // construcción desde una secuencia ordenada
+  std::vector<std::pair<int, int>> sorted;
+  for (int k = 0; k < 777; k++) sorted.push_back({3 * k, k});
+  tree.build_from_sorted(sorted.begin(), sorted.end());
+  ref = std::map<int, int>(sorted.begin(), sorted.end());
+  check(tree, ref);
+}
+
+int main() {
+  testBackend<nodeBackend>();
+  testBackend<leafBackend>();
+  testBackend<withRank<nodeBackend>>();
+  testBackend<withRank<leafBackend>>();
+
+  std::cout << "Pruebas básicas superadas.\n";
+}
@@ -0,0 +1,447 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <iostream>
+#include <cstddef>
+#include "../common/memoryUsage.h"
+
+// Árbol B+ en memoria con la misma interfaz que leafTree (insert, find,
+// deleteNode). Los nodos internos guardan varias claves de enrutamiento y
+// ocupan unas pocas líneas de caché, y las hojas están enlazadas en una lista
+// doble. Así una búsqueda hace ~log_F(n) saltos de puntero en lugar de log2(n).
+//
+// Los punteros devueltos por insert/find apuntan dentro de una hoja y dejan de
+// ser válidos tras la siguiente inserción o borrado.
+
+constexpr int bPlusFanout(size_t nodeBytes, size_t bytesPerKey)
+{
+  return int((nodeBytes - 4 * sizeof(void*)) / bytesPerKey) - 1 > 3 ?
+    int((nodeBytes - 4 * sizeof(void*)) / bytesPerKey) - 1 : 3;
+}
+
+template<typename T, typename B>
+class bPlusTree {
+  public:
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr size_t NODE_BYTES = 4 * CACHE_LINE;
+
+  // Capacidades para que cada nodo quepa en NODE_BYTES (se reserva una
+  // posición extra para insertar antes de dividir).
+  static constexpr int INNER_KEYS = bPlusFanout(NODE_BYTES, sizeof(T) + sizeof(void*));
+  static constexpr int LEAF_KEYS = bPlusFanout(NODE_BYTES, sizeof(T) + sizeof(B));
+
+  private:
+  struct bNode {
+    bool leaf;
+    int count;
+    bNode(bool nleaf) : leaf(nleaf), count(0) {}
+  };
+
+  struct alignas(CACHE_LINE) innerNode : bNode {
+    T keys[INNER_KEYS + 1];
+    bNode* child[INNER_KEYS + 2];
+    innerNode() : bNode(false) {}
+  };
+
+  struct alignas(CACHE_LINE) leafNode : bNode {
+    leafNode* prev;
+    leafNode* next;
+    T keys[LEAF_KEYS + 1];
+    B vals[LEAF_KEYS + 1];
+    leafNode() : bNode(true), prev(nullptr), next(nullptr) {}
+  };
+
+  bNode* root;
+  size_t size;
+
+  public:
+  bPlusTree();
+  ~bPlusTree();
+  bPlusTree(const bPlusTree&) = delete;
+  bPlusTree& operator=(const bPlusTree&) = delete;
+
+  B* insert(T key, B val);
+  B* find(T key);
+  bool deleteNode(T key);
+  size_t getSize() const { return size; }
+
+  // Recorre sólo los nodos, O(n / LEAF_KEYS). Las posiciones libres dentro
+  // de cada nodo cuentan como nodeBytes.
+  memoryUsage memory_usage() const;
+
+  private:
+  static int childIndex(const innerNode* n, const T& key);
+  static int leafIndex(const leafNode* n, const T& key);
+
+  B* insert(bNode* actual, const T& key, const B& val, T& upKey, bNode*& upNode);
+  bool deleteNode(bNode* actual, const T& key);
+  void fixChild(innerNode* parent, int i);
+
+  void destroyTree(bNode* actual);
+  static void countNodes(const bNode* actual, memoryUsage& m);
+};
+
+template<typename T, typename B>
+bPlusTree<T,B>::bPlusTree() : root(nullptr), size(0) {}
+
+template<typename T, typename B>
+bPlusTree<T,B>::~bPlusTree() {
+  destroyTree(root);
+}
+
+template<typename T, typename B>
+void bPlusTree<T,B>::destroyTree(bNode* actual)
+{
+  if (actual == nullptr) return;
+  if (actual->leaf) {
+    delete static_cast<leafNode*>(actual);
+    return;
+  }
+  innerNode* in = static_cast<innerNode*>(actual);
+  for (int i = 0; i <= in->count; i++) {
+    destroyTree(in->child[i]);
+  }
+  delete in;
+}
+
+// Número de claves <= key: índice del hijo por el que bajar
+template<typename T, typename B>
+int bPlusTree<T,B>::childIndex(const innerNode* n, const T& key)
+{
+  int i = 0;
+  while (i < n->count && !(key < n->keys[i])) i++;
+  return i;
+}
+
+// Primera posición con clave >= key
+template<typename T, typename B>
+int bPlusTree<T,B>::leafIndex(const leafNode* n, const T& key)
+{
+  int i = 0;
+  while (i < n->count && n->keys[i] < key) i++;
+  return i;
+}
+
+template<typename T, typename B>
+B* bPlusTree<T,B>::find(T key)
+{
+  bNode* actual = root;
+  if (actual == nullptr) return nullptr;
+
+  while (!actual->leaf) {
+    innerNode* in = static_cast<innerNode*>(actual);
+    actual = in->child[childIndex(in, key)];
+  }
+
+  leafNode* lf = static_cast<leafNode*>(actual);
+  int i = leafIndex(lf, key);
+  if (i < lf->count && lf->keys[i] == key) {
+    return &lf->vals[i];
+  }
+  return nullptr;
+}
+
+template<typename T, typename B>
+B* bPlusTree<T,B>::insert(T key, B val)
+{
+  if (root == nullptr) {
+    root = new leafNode();
+  }
+
+  T upKey;
+  bNode* upNode = nullptr;
+  B* result = insert(root, key, val, upKey, upNode);
+
+  // La raíz se dividió: crecer un nivel
+  if (upNode != nullptr) {
+    innerNode* newRoot = new innerNode();
+    newRoot->keys[0] = upKey;
+    newRoot->child[0] = root;
+    newRoot->child[1] = upNode;
+    newRoot->count = 1;
+    root = newRoot;
+  }
+  return result;
+}
+
+// Inserta en el subárbol. Si el nodo se divide, devuelve en upKey/upNode la
+// clave separadora y el nuevo hermano derecho para que el padre los enlace.
+template<typename T, typename B>
+B* bPlusTree<T,B>::insert(bNode* actual, const T& key, const B& val, T& upKey, bNode*& upNode)
+{
+  if (actual->leaf) {
+    leafNode* lf = static_cast<leafNode*>(actual);
+    int pos = leafIndex(lf, key);
+    if (pos < lf->count && lf->keys[pos] == key) {
+      lf->vals[pos] = val;
+      return &lf->vals[pos];
+    }
+
+    for (int j = lf->count; j > pos; j--) {
+      lf->keys[j] = lf->keys[j - 1];
+      lf->vals[j] = lf->vals[j - 1];
+    }
+    lf->keys[pos] = key;
+    lf->vals[pos] = val;
+    lf->count++;
+    size++;
+
+    if (lf->count <= LEAF_KEYS) {
+      return &lf->vals[pos];
+    }
+
+    // Dividir la hoja y enlazar la nueva página a la derecha
+    leafNode* right = new leafNode();
+    int half = lf->count / 2;
+    for (int j = half; j < lf->count; j++) {
+      right->keys[j - half] = lf->keys[j];
+      right->vals[j - half] = lf->vals[j];
+    }
+    right->count = lf->count - half;
+    lf->count = half;
+
+    right->next = lf->next;
+    right->prev = lf;
+    if (lf->next) lf->next->prev = right;
+    lf->next = right;
+
+    upKey = right->keys[0];
+    upNode = right;
+    return pos < half ? &lf->vals[pos] : &right->vals[pos - half];
+  }
+
+  innerNode* in = static_cast<innerNode*>(actual);
+  int i = childIndex(in, key);
+
+  T childKey;
+  bNode* childNode = nullptr;
+  B* result = insert(in->child[i], key, val, childKey, childNode);
+  if (childNode == nullptr) {
+    return result;
+  }
+
+  for (int j = in->count; j > i; j--) {
+    in->keys[j] = in->keys[j - 1];
+    in->child[j + 1] = in->child[j];
+  }
+  in->keys[i] = childKey;
+  in->child[i + 1] = childNode;
+  in->count++;
+
+  if (in->count <= INNER_KEYS) {
+    return result;
+  }
+
+  // Dividir el nodo interno: la clave del medio sube al padre
+  innerNode* right = new innerNode();
+  int mid = in->count / 2;
+  upKey = in->keys[mid];
+  for (int j = mid + 1; j < in->count; j++) {
+    right->keys[j - mid - 1] = in->keys[j];
+  }
+  for (int j = mid + 1; j <= in->count; j++) {
+    right->child[j - mid - 1] = in->child[j];
+  }
+  right->count = in->count - mid - 1;
+  in->count = mid;
+  upNode = right;
+  return result;
+}
+
+template<typename T, typename B>
+bool bPlusTree<T,B>::deleteNode(T key)
+{
+  if (root == nullptr) return false;
+
+  bool deleted = deleteNode(root, key);
+
+  if (root->leaf) {
+    if (root->count == 0) {
+      delete static_cast<leafNode*>(root);
+      root = nullptr;
+    }
+  } else if (root->count == 0) {
+    // La raíz interna se quedó con un solo hijo: bajar un nivel
+    innerNode* old = static_cast<innerNode*>(root);
+    root = old->child[0];
+    delete old;
+  }
+  return deleted;
+}
+
+template<typename T, typename B>
+bool bPlusTree<T,B>::deleteNode(bNode* actual, const T& key)
+{
+  if (actual->leaf) {
+    leafNode* lf = static_cast<leafNode*>(actual);
+    int pos = leafIndex(lf, key);
+    if (pos == lf->count || !(lf->keys[pos] == key)) {
+      return false;
+    }
+    for (int j = pos; j + 1 < lf->count; j++) {
+      lf->keys[j] = lf->keys[j + 1];
+      lf->vals[j] = lf->vals[j + 1];
+    }
+    lf->count--;
+    size--;
+    return true;
+  }
+
+  innerNode* in = static_cast<innerNode*>(actual);
+  int i = childIndex(in, key);
+  if (!deleteNode(in->child[i], key)) {
+    return false;
+  }
+
+  bNode* child = in->child[i];
+  int minCount = child->leaf ? LEAF_KEYS / 2 : INNER_KEYS / 2;
+  if (child->count < minCount) {
+    fixChild(in, i);
+  }
+  return true;
+}
+
+// El hijo i quedó por debajo de la ocupación mínima: pedir prestado a un
+// hermano o fusionarse con él.
+template<typename T, typename B>
+void bPlusTree<T,B>::fixChild(innerNode* parent, int i)
+{
+  bNode* child = parent->child[i];
+  bNode* left = i > 0 ? parent->child[i - 1] : nullptr;
+  bNode* right = i < parent->count ? parent->child[i + 1] : nullptr;
+
+  if (child->leaf) {
+    leafNode* c = static_cast<leafNode*>(child);
+    leafNode* l = static_cast<leafNode*>(left);
+    leafNode* r = static_cast<leafNode*>(right);
+    int minCount = LEAF_KEYS / 2;
+
+    if (l && l->count > minCount) {
+      for (int j = c->count; j > 0; j--) {
+        c->keys[j] = c->keys[j - 1];
+        c->vals[j] = c->vals[j - 1];
+      }
+      c->keys[0] = l->keys[l->count - 1];
+      c->vals[0] = l->vals[l->count - 1];
+      c->count++;
+      l->count--;
+      parent->keys[i - 1] = c->keys[0];
+      return;
+    }
+
+    if (r && r->count > minCount) {
+      c->keys[c->count] = r->keys[0];
+      c->vals[c->count] = r->vals[0];
+      c->count++;
+      for (int j = 0; j + 1 < r->count; j++) {
+        r->keys[j] = r->keys[j + 1];
+        r->vals[j] = r->vals[j + 1];
+      }
+      r->count--;
+      parent->keys[i] = r->keys[0];
+      return;
+    }
+
+    // Fusionar: la hoja derecha del par se vacía en la izquierda
+    int sep = l ? i - 1 : i;
+    leafNode* dst = l ? l : c;
+    leafNode* src = l ? c : r;
+    for (int j = 0; j < src->count; j++) {
+      dst->keys[dst->count + j] = src->keys[j];
+      dst->vals[dst->count + j] = src->vals[j];
+    }
+    dst->count += src->count;
+    dst->next = src->next;
+    if (src->next) src->next->prev = dst;
+    delete src;
+
+    for (int j = sep; j + 1 < parent->count; j++) {
+      parent->keys[j] = parent->keys[j + 1];
+      parent->child[j + 1] = parent->child[j + 2];
+    }
+    parent->count--;
+    return;
+  }
+
+  innerNode* c = static_cast<innerNode*>(child);
+  innerNode* l = static_cast<innerNode*>(left);
+  innerNode* r = static_cast<innerNode*>(right);
+  int minCount = INNER_KEYS / 2;
+
+  if (l && l->count > minCount) {
+    for (int j = c->count; j > 0; j--) {
+      c->keys[j] = c->keys[j - 1];
+    }
+    for (int j = c->count + 1; j > 0; j--) {
+      c->child[j] = c->child[j - 1];
+    }
+    c->keys[0] = parent->keys[i - 1];
+    c->child[0] = l->child[l->count];
+    c->count++;
+    parent->keys[i - 1] = l->keys[l->count - 1];
+    l->count--;
+    return;
+  }
+
+  if (r && r->count > minCount) {
+    c->keys[c->count] = parent->keys[i];
+    c->child[c->count + 1] = r->child[0];
+    c->count++;
+    parent->keys[i] = r->keys[0];
+    for (int j = 0; j + 1 < r->count; j++) {
+      r->keys[j] = r->keys[j + 1];
+    }
+    for (int j = 0; j < r->count; j++) {
+      r->child[j] = r->child[j + 1];
+    }
+    r->count--;
+    return;
+  }
+
+  // Fusionar dos nodos internos bajando la clave separadora del padre
+  int sep = l ? i - 1 : i;
+  innerNode* dst = l ? l : c;
+  innerNode* src = l ? c : r;
+  dst->keys[dst->count] = parent->keys[sep];
+  for (int j = 0; j < src->count; j++) {
+    dst->keys[dst->count + 1 + j] = src->keys[j];
+  }
+  for (int j = 0; j <= src->count; j++) {
+    dst->child[dst->count + 1 + j] = src->child[j];
+  }
+  dst->count += src->count + 1;
+  delete src;
+
+  for (int j = sep; j + 1 < parent->count; j++) {
+    parent->keys[j] = parent->keys[j + 1];
+    parent->child[j + 1] = parent->child[j + 2];
+  }
+  parent->count--;
+}
+
+template<typename T, typename B>
+memoryUsage bPlusTree<T,B>::memory_usage() const
+{
+  memoryUsage m;
+  if (root != nullptr) countNodes(root, m);
+  m.nodeBytes = m.internalNodes * sizeof(innerNode) + m.leafNodes * sizeof(leafNode);
+  m.overheadBytes = m.internalNodes * (heapBlockBytes(sizeof(innerNode)) - sizeof(innerNode)) +
+                    m.leafNodes * (heapBlockBytes(sizeof(leafNode)) - sizeof(leafNode)) + sizeof(*this);
+  return m;
+}
+
+template<typename T, typename B>
+void bPlusTree<T,B>::countNodes(const bNode* actual, memoryUsage& m)
+{
+  if (actual->leaf) {
+    m.leafNodes++;
+    return;
+  }
+  m.internalNodes++;
+  const innerNode* in = static_cast<const innerNode*>(actual);
+  for (int i = 0; i <= in->count; i++) {
+    countNodes(in->child[i], m);
+  }
+}
+
+#endif
@@ -1,7 +1,14 @@
 #ifndef LEAFTREE_H
 #define LEAFTREE_H
 
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "../common/nodePool.h"
+#include "../common/treeStats.h"
+#include "../common/memoryUsage.h"
 
 template<typename T, typename B>
 class node {
@@ -12,24 +19,71 @@ class node {
     node* right;
     node* parent;
     bool leaf;
+    node* prev = nullptr; // hojas vecinas en orden; nulos en los internos
+    node* next = nullptr;
     node(T nkey, B nval, node* nleft = nullptr, node* nright = nullptr, node* nparent = nullptr, bool nleaf = false);
 };
 
-template<typename T, typename B>
+// Las hojas están encadenadas en orden de clave, así que recorrer k claves
+// desde lower_bound cuesta O(log n + k) sin volver a bajar por el árbol.
+// Stats: noStats o countingStats (ver common/treeStats.h)
+template<typename T, typename B, typename Alloc = nodePool<node<T,B>>, typename Stats = noStats>
 class leafTree {
   node<T,B>* root;
   size_t size;
+  Alloc alloc;
+  [[no_unique_address]] Stats stats;
 
   public:
-  leafTree(node<T,B>* nnode = nullptr);
+  // Sigue los enlaces entre hojas; end() es nulo y --end() da la última
+  class iterator {
+    node<T,B>* actual = nullptr;
+    const leafTree* tree = nullptr;
+    friend class leafTree;
+    iterator(node<T,B>* n, const leafTree* t) : actual(n), tree(t) {}
+
+    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const T&, const B&>;
+    using reference = value_type;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    const T& key() const { return actual->key; }
+    const B& value() const { return actual->val; }
+    reference operator*() const { return {actual->key, actual->val}; }
+    iterator& operator++() { actual = actual->next; return *this; }
+    iterator& operator--() { actual = actual ? actual->prev : tree->lastLeaf(); return *this; }
+    iterator operator++(int) { iterator t = *this; ++*this; return t; }
+    iterator operator--(int) { iterator t = *this; --*this; return t; }
+    bool operator==(const iterator& o) const { return actual == o.actual; }
+  };
+
+  leafTree();
   ~leafTree();
+  leafTree(const leafTree&) = delete;
+  leafTree& operator=(const leafTree&) = delete;
   node<T, B>* deleteNode(T key);
   node<T, B>* find(T key);
   node<T, B>* insert(T key, B val);
   size_t getSize() const { return size; }
 
+  iterator begin() const { return iterator(firstLeaf(), this); }
+  iterator end() const { return iterator(nullptr, this); }
+  // Primera clave >= key / > key
+  iterator lower_bound(T key);
+  iterator upper_bound(T key);
+
+  statsSnapshot getStats() const { return stats.snapshot(); }
+  void resetStats() { stats.reset(); }
+
+  // Nodos contados por el asignador: size hojas y el resto de enrutado
+  memoryUsage memory_usage() const;
+
   private:
   node<T, B>* findNode(T key);
+  node<T, B>* firstLeaf() const;
+  node<T, B>* lastLeaf() const;
   node<T, B>* findParent(T key, node<T, B>* actual, node<T, B>* parent);
   node<T, B>* findNode(T key, node<T, B>* actual);
   node<T, B>* find(T key, node<T, B>* actual);
@@ -40,35 +94,38 @@ template<typename T, typename B>
 node<T,B>::node(T nkey, B nval, node* nleft, node* nright, node* nparent, bool nleaf) : 
   key(nkey), val(nval), left(nleft), right(nright), parent(nparent), leaf(nleaf) {}
 
-  template<typename T, typename B>
-  leafTree<T,B>::leafTree(node<T,B>* nnode) : root(nnode), size(nnode ? 1 : 0) {}
+  template<typename T, typename B, typename Alloc, typename Stats>
+  leafTree<T,B,Alloc,Stats>::leafTree() : root(nullptr), size(0) {}
 
-  template<typename T, typename B>
-  leafTree<T,B>::~leafTree() {
-    destroyTree(root);
+  template<typename T, typename B, typename Alloc, typename Stats>
+  leafTree<T,B,Alloc,Stats>::~leafTree() {
+    if (!Alloc::bulkRelease || !std::is_trivially_destructible<node<T,B>>::value) {
+      destroyTree(root);
+    }
+    alloc.release();
   }
 
-template<typename T, typename B>
-void leafTree<T,B>::destroyTree(node<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+void leafTree<T,B,Alloc,Stats>::destroyTree(node<T, B>* actual) 
 {
   if (actual != nullptr) {
     destroyTree(actual->left);
     destroyTree(actual->right);
-    delete actual;
+    alloc.destroy(actual);
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findNode(T key) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::findNode(T key) 
 { 
   return findNode(key, root); 
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::insert(T key, B val) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::insert(T key, B val) 
 {
   if (root == nullptr) {
-    root = new node<T, B>(key, val, nullptr, nullptr, nullptr, true);
+    root = alloc.create(key, val, nullptr, nullptr, nullptr, true);
     size++;
     return root;
   }
@@ -76,30 +133,51 @@ node<T, B>* leafTree<T,B>::insert(T key, B val)
   node<T, B>* parent = findNode(key);
   if (!parent) return nullptr;
 
-  node<T, B>* old_node = new node<T,B>(parent->key, parent->val, nullptr, nullptr, parent, true);
-  node<T, B>* new_node = new node<T,B>(key, val, nullptr, nullptr, parent, true);
+  // Clave ya existente: actualizar valor
+  stats.compare();
+  if (parent->key == key) {
+    parent->val = val;
+    return parent;
+  }
+
+  node<T, B>* old_node = alloc.create(parent->key, parent->val, nullptr, nullptr, parent, true);
+  node<T, B>* new_node = alloc.create(key, val, nullptr, nullptr, parent, true);
 
+  // old_node toma el sitio de parent en la lista y new_node va a su lado
+  old_node->prev = parent->prev;
+  old_node->next = parent->next;
   if (parent->key < key) {
     parent->key = key;
     parent->right = new_node;
     parent->left = old_node;
+    new_node->prev = old_node;
+    new_node->next = old_node->next;
   } else {
     parent->right = old_node;
     parent->left = new_node;
+    new_node->prev = old_node->prev;
+    new_node->next = old_node;
   }
+  if (old_node->prev) old_node->prev->next = old_node;
+  if (old_node->next) old_node->next->prev = old_node;
+  if (new_node->prev) new_node->prev->next = new_node;
+  if (new_node->next) new_node->next->prev = new_node;
   size++;
 
   parent->leaf = false;
+  parent->prev = parent->next = nullptr;
 
   return new_node;
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findNode(T key, node<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::findNode(T key, node<T, B>* actual) 
 {
   if (actual == nullptr)
     return nullptr;
 
+  stats.visit();
+  stats.compare();
   if (actual->key <= key) {
     if (actual->right == nullptr) 
       return actual;
@@ -111,37 +189,80 @@ node<T, B>* leafTree<T,B>::findNode(T key, node<T, B>* actual)
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::find(T key) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::firstLeaf() const
+{
+  node<T, B>* actual = root;
+  while (actual != nullptr && !actual->leaf) actual = actual->left;
+  return actual;
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::lastLeaf() const
+{
+  node<T, B>* actual = root;
+  while (actual != nullptr && !actual->leaf) actual = actual->right;
+  return actual;
+}
+
+// findNode baja a la hoja con la mayor clave <= key o, si no hay ninguna, a
+// la primera: el límite es esa hoja o la siguiente
+template<typename T, typename B, typename Alloc, typename Stats>
+typename leafTree<T,B,Alloc,Stats>::iterator leafTree<T,B,Alloc,Stats>::lower_bound(T key)
 {
+  node<T, B>* leaf = findNode(key);
+  if (leaf) stats.compare();
+  if (leaf && leaf->key < key) leaf = leaf->next;
+  return iterator(leaf, this);
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+typename leafTree<T,B,Alloc,Stats>::iterator leafTree<T,B,Alloc,Stats>::upper_bound(T key)
+{
+  node<T, B>* leaf = findNode(key);
+  if (leaf) stats.compare();
+  if (leaf && leaf->key <= key) leaf = leaf->next;
+  return iterator(leaf, this);
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::find(T key) 
+{
+  stats.beginSearch();
   node<T, B>* result = find(key, root);
+  stats.endSearch();
+  if (result) stats.compare();
   if (result && result->key == key) {
     return result;
   }
   return nullptr;
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::find(T key, node<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::find(T key, node<T, B>* actual) 
 {
   if (actual == nullptr)
     return nullptr;
 
+  stats.visit();
+  stats.compare();
   if (actual->key <= key && !actual->leaf) {
     if (actual->right == nullptr) 
       return actual;
     return find(key, actual->right);
   } else if (actual->key > key && !actual->leaf){
+    stats.compare();
     if (actual->left == nullptr) 
       return actual;
     return find(key, actual->left);
   } else {
+    stats.compare();
     return actual;
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::findParent(T key, node<T, B>* actual, node<T, B>* parent) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::findParent(T key, node<T, B>* actual, node<T, B>* parent) 
 {
   if (actual == nullptr)
     return nullptr;
@@ -161,8 +282,8 @@ node<T, B>* leafTree<T,B>::findParent(T key, node<T, B>* actual, node<T, B>* par
   }
 }
 
-template<typename T, typename B>
-node<T, B>* leafTree<T,B>::deleteNode(T key) 
+template<typename T, typename B, typename Alloc, typename Stats>
+node<T, B>* leafTree<T,B,Alloc,Stats>::deleteNode(T key) 
 {
   if (root == nullptr) {
     return nullptr;
@@ -170,13 +291,11 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
 
   if (root->left == nullptr && root->right == nullptr) {
     if (root->key == key) {
-      node<T, B>* deleted = root;
+      alloc.destroy(root);
       root = nullptr;
       size--;
-      return deleted;
-    } else {
-      return nullptr;
     }
+    return root;
   }
 
   node<T, B>* tmp_node = root;
@@ -185,6 +304,8 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
 
   while (tmp_node->right != nullptr) {
     upper_node = tmp_node;
+    stats.visit();
+    stats.compare();
     if (key < tmp_node->key) {
       tmp_node = upper_node->left;
       other_node = upper_node->right;
@@ -194,24 +315,45 @@ node<T, B>* leafTree<T,B>::deleteNode(T key)
     }
   }
 
+  stats.visit();
+  stats.compare();
   if (tmp_node->key != key) {
-    return nullptr;
+    return root;
   }
 
+  if (tmp_node->prev) tmp_node->prev->next = tmp_node->next;
+  if (tmp_node->next) tmp_node->next->prev = tmp_node->prev;
+
   upper_node->key = other_node->key;
   upper_node->val = other_node->val;
   upper_node->left = other_node->left;
   upper_node->right = other_node->right;
   upper_node->leaf = other_node->leaf;
+  upper_node->prev = other_node->prev;
+  upper_node->next = other_node->next;
 
   if (other_node->left) other_node->left->parent = upper_node;
   if (other_node->right) other_node->right->parent = upper_node;
+  // Si el hermano era hoja, upper_node ocupa ahora su sitio en la lista
+  if (upper_node->prev) upper_node->prev->next = upper_node;
+  if (upper_node->next) upper_node->next->prev = upper_node;
 
-  node<T, B>* deleted_object = tmp_node;
-  delete other_node;
+  alloc.destroy(tmp_node);
+  alloc.destroy(other_node);
   size--;
 
-  return deleted_object;
+  return root;
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+memoryUsage leafTree<T,B,Alloc,Stats>::memory_usage() const
+{
+  memoryUsage m;
+  m.leafNodes = size;
+  m.internalNodes = alloc.liveNodes() - size;
+  m.nodeBytes = alloc.liveNodes() * sizeof(node<T,B>);
+  m.overheadBytes = alloc.overheadBytes() + sizeof(*this);
+  return m;
 }
 
 #endif
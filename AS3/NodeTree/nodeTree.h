@@ -3,6 +3,13 @@
 
 #include <iostream>
 #include <algorithm>
+#include <type_traits>
+#include <span>
+#include <vector>
+#include "../common/nodePool.h"
+#include "../common/frozenTree.h"
+#include "../common/treeStats.h"
+#include "../common/memoryUsage.h"
 
 template<typename T, typename B>
 class nodeT {
@@ -16,23 +23,43 @@ class nodeT {
     nodeT(T nkey, B nval, nodeT* nleft = nullptr, nodeT* nright = nullptr, nodeT* nparent = nullptr);
 };
 
-template<typename T, typename B>
+// Stats: noStats o countingStats (ver common/treeStats.h)
+template<typename T, typename B, typename Alloc = nodePool<nodeT<T,B>>, typename Stats = noStats>
 class nodeTree {
   nodeT<T,B>* root;
   size_t size;
+  Alloc alloc;
+  [[no_unique_address]] Stats stats;
 
   public:
-  nodeTree(nodeT<T,B>* nnode = nullptr);
+  typedef nodeT<T,B>* find_result;
+  static constexpr size_t BATCH_GROUP = 16;
+
+  nodeTree();
   ~nodeTree();
+  nodeTree(const nodeTree&) = delete;
+  nodeTree& operator=(const nodeTree&) = delete;
 
   nodeT<T, B>* insert(T key, B val);
   nodeT<T, B>* find(T key);
   nodeT<T, B>* deleteNode(T key);
 
+  // Busca varias claves a la vez; out[i] recibe el resultado de keys[i]
+  void find_batch(std::span<const T> keys, std::span<find_result> out) const;
+
   nodeT<T, B>* getMin();
   nodeT<T, B>* getMax();
   size_t getSize() const { return size; }
 
+  statsSnapshot getStats() const { return stats.snapshot(); }
+  void resetStats() { stats.reset(); }
+
+  // Nodos contados por el asignador; todos guardan un par
+  memoryUsage memory_usage() const;
+
+  // Instantánea de sólo lectura en orden de Eytzinger, O(n)
+  frozenTree<T, B> freeze() const;
+
   private:
   nodeT<T, B>* insert(T key, B val, nodeT<T, B>* actual, nodeT<T, B>* parent);
 
@@ -43,50 +70,59 @@ class nodeTree {
   nodeT<T, B>* findMax(nodeT<T, B>* actual);
 
   void destroyTree(nodeT<T, B>* actual);
+  void collectInorder(nodeT<T, B>* actual, std::vector<T>& keys, std::vector<B>& vals) const;
 };
 
 template<typename T, typename B>
 nodeT<T,B>::nodeT(T nkey, B nval, nodeT* nleft, nodeT* nright, nodeT* nparent) : 
   key(nkey), val(nval), left(nleft), right(nright), parent(nparent) {}
 
-  template<typename T, typename B>
-  nodeTree<T,B>::nodeTree(nodeT<T,B>* nnode) : root(nnode), size(nnode ? 1 : 0) {}
+  template<typename T, typename B, typename Alloc, typename Stats>
+  nodeTree<T,B,Alloc,Stats>::nodeTree() : root(nullptr), size(0) {}
 
-  template<typename T, typename B>
-  nodeTree<T,B>::~nodeTree() {
-    destroyTree(root);
+  // Con un pool y nodos triviales basta con soltar los slabs: O(1) por slab
+  // en lugar de recorrer el árbol completo.
+  template<typename T, typename B, typename Alloc, typename Stats>
+  nodeTree<T,B,Alloc,Stats>::~nodeTree() {
+    if (!Alloc::bulkRelease || !std::is_trivially_destructible<nodeT<T,B>>::value) {
+      destroyTree(root);
+    }
+    alloc.release();
   }
 
-template<typename T, typename B>
-void nodeTree<T,B>::destroyTree(nodeT<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+void nodeTree<T,B,Alloc,Stats>::destroyTree(nodeT<T, B>* actual) 
 {
   if (actual != nullptr) {
     destroyTree(actual->left);
     destroyTree(actual->right);
-    delete actual;
+    alloc.destroy(actual);
   }
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::insert(T key, B val) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::insert(T key, B val) 
 {
   root = insert(key, val, root, nullptr);
   return root;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::insert(T key, B val, nodeT<T, B>* actual, nodeT<T, B>* parent) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::insert(T key, B val, nodeT<T, B>* actual, nodeT<T, B>* parent) 
 {
   if (actual == nullptr) {
     size++;
-    return new nodeT<T, B>(key, val, nullptr, nullptr, parent);
+    return alloc.create(key, val, nullptr, nullptr, parent);
   }
 
+  stats.visit();
+  stats.compare();
   if (key == actual->key) {
     actual->val = val;
     return actual;
   }
 
+  stats.compare();
   if (key < actual->key) {
     actual->left = insert(key, val, actual->left, actual);
   } else {
@@ -96,23 +132,29 @@ nodeT<T, B>* nodeTree<T,B>::insert(T key, B val, nodeT<T, B>* actual, nodeT<T, B
   return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::find(T key) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::find(T key) 
 {
-  return find(key, root);
+  stats.beginSearch();
+  nodeT<T, B>* result = find(key, root);
+  stats.endSearch();
+  return result;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::find(T key, nodeT<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::find(T key, nodeT<T, B>* actual) 
 {
   if (actual == nullptr) {
     return nullptr;
   }
 
+  stats.visit();
+  stats.compare();
   if (key == actual->key) {
     return actual;
   }
 
+  stats.compare();
   if (key < actual->key) {
     return find(key, actual->left);
   } else {
@@ -120,42 +162,84 @@ nodeT<T, B>* nodeTree<T,B>::find(T key, nodeT<T, B>* actual)
   }
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::deleteNode(T key) 
+// Las búsquedas avanzan en grupos de BATCH_GROUP, un nivel por ronda: al
+// bajar se precarga el siguiente nodo y, mientras llega, se avanza en las
+// demás claves del grupo. Así los fallos de caché se solapan entre claves.
+template<typename T, typename B, typename Alloc, typename Stats>
+void nodeTree<T,B,Alloc,Stats>::find_batch(std::span<const T> keys, std::span<find_result> out) const
+{
+  for (size_t base = 0; base < keys.size(); base += BATCH_GROUP) {
+    size_t m = std::min(BATCH_GROUP, keys.size() - base);
+    nodeT<T, B>* cur[BATCH_GROUP];
+    for (size_t i = 0; i < m; i++) {
+      cur[i] = root;
+      out[base + i] = nullptr;
+    }
+
+    size_t active = root != nullptr ? m : 0;
+    while (active > 0) {
+      active = 0;
+      for (size_t i = 0; i < m; i++) {
+        nodeT<T, B>* actual = cur[i];
+        if (actual == nullptr) continue;
+
+        const T& key = keys[base + i];
+        if (key == actual->key) {
+          out[base + i] = actual;
+          cur[i] = nullptr;
+          continue;
+        }
+        actual = key < actual->key ? actual->left : actual->right;
+        cur[i] = actual;
+        if (actual != nullptr) {
+          __builtin_prefetch(actual);
+          active++;
+        }
+      }
+    }
+  }
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::deleteNode(T key) 
 {
   root = deleteNode(key, root);
   return root;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::deleteNode(T key, nodeT<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::deleteNode(T key, nodeT<T, B>* actual) 
 {
   if (actual == nullptr) {
     return nullptr;
   }
 
+  stats.visit();
+  stats.compare();
   if (key < actual->key) {
     actual->left = deleteNode(key, actual->left);
   } else if (key > actual->key) {
+    stats.compare();
     actual->right = deleteNode(key, actual->right);
   } else {
+    stats.compare();
     size--;
 
     if (actual->left == nullptr && actual->right == nullptr) {
-      delete actual;
+      alloc.destroy(actual);
       return nullptr;
     }
 
     if (actual->left == nullptr) {
       nodeT<T, B>* temp = actual->right;
       temp->parent = actual->parent;
-      delete actual;
+      alloc.destroy(actual);
       return temp;
     }
     if (actual->right == nullptr) {
       nodeT<T, B>* temp = actual->left;
       temp->parent = actual->parent;
-      delete actual;
+      alloc.destroy(actual);
       return temp;
     }
 
@@ -171,21 +255,22 @@ nodeT<T, B>* nodeTree<T,B>::deleteNode(T key, nodeT<T, B>* actual)
   return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::findMin(nodeT<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::findMin(nodeT<T, B>* actual) 
 {
   if (actual == nullptr) {
     return nullptr;
   }
 
   while (actual->left != nullptr) {
+    stats.visit();
     actual = actual->left;
   }
   return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::findMax(nodeT<T, B>* actual) 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::findMax(nodeT<T, B>* actual) 
 {
   if (actual == nullptr) {
     return nullptr;
@@ -197,16 +282,48 @@ nodeT<T, B>* nodeTree<T,B>::findMax(nodeT<T, B>* actual)
   return actual;
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::getMin() 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::getMin() 
 {
   return findMin(root);
 }
 
-template<typename T, typename B>
-nodeT<T, B>* nodeTree<T,B>::getMax() 
+template<typename T, typename B, typename Alloc, typename Stats>
+nodeT<T, B>* nodeTree<T,B,Alloc,Stats>::getMax() 
 {
   return findMax(root);
 }
 
+template<typename T, typename B, typename Alloc, typename Stats>
+frozenTree<T, B> nodeTree<T,B,Alloc,Stats>::freeze() const
+{
+  std::vector<T> keys;
+  std::vector<B> vals;
+  keys.reserve(size);
+  vals.reserve(size);
+  collectInorder(root, keys, vals);
+  return frozenTree<T, B>(keys, vals);
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+void nodeTree<T,B,Alloc,Stats>::collectInorder(nodeT<T, B>* actual, std::vector<T>& keys, std::vector<B>& vals) const
+{
+  if (actual != nullptr) {
+    collectInorder(actual->left, keys, vals);
+    keys.push_back(actual->key);
+    vals.push_back(actual->val);
+    collectInorder(actual->right, keys, vals);
+  }
+}
+
+template<typename T, typename B, typename Alloc, typename Stats>
+memoryUsage nodeTree<T,B,Alloc,Stats>::memory_usage() const
+{
+  memoryUsage m;
+  m.leafNodes = alloc.liveNodes();
+  m.nodeBytes = alloc.liveNodes() * sizeof(nodeT<T,B>);
+  m.overheadBytes = alloc.overheadBytes() + sizeof(*this);
+  return m;
+}
+
 #endif
@@ -35,6 +35,9 @@ def load_and_plot_results(filename='tree_benchmark_results.csv'):
     ax1 = axes[0, 0]
     ax1.plot(df['n'], df['nodeTree_insert_median'], 'o-', label='Node Tree', linewidth=2, markersize=6)
     ax1.plot(df['n'], df['leafTree_insert_median'], 's-', label='Leaf Tree', linewidth=2, markersize=6)
+    if 'bPlusTree_insert_median' in df:
+        ax1.plot(df['n'], df['bPlusTree_insert_median'], '^-', label='B+ Tree', linewidth=2, markersize=6)
+        ax1.plot(df['n'], df['rbLeafTree_insert_median'], 'd-', label='RB Leaf Tree', linewidth=2, markersize=6)
     ax1.set_xlabel('Tamaño del árbol (n)')
     ax1.set_ylabel('Tiempo mediano de inserción (μs)')
     ax1.set_title('a) Tiempo de Inserción')
@@ -47,6 +50,9 @@ def load_and_plot_results(filename='tree_benchmark_results.csv'):
     ax2 = axes[0, 1]
     ax2.plot(df['n'], df['nodeTree_successful_search_median'], 'o-', label='Node Tree', linewidth=2, markersize=6)
     ax2.plot(df['n'], df['leafTree_successful_search_median'], 's-', label='Leaf Tree', linewidth=2, markersize=6)
+    if 'bPlusTree_successful_search_median' in df:
+        ax2.plot(df['n'], df['bPlusTree_successful_search_median'], '^-', label='B+ Tree', linewidth=2, markersize=6)
+        ax2.plot(df['n'], df['rbLeafTree_successful_search_median'], 'd-', label='RB Leaf Tree', linewidth=2, markersize=6)
     ax2.set_xlabel('Tamaño del árbol (n)')
     ax2.set_ylabel('Tiempo mediano de búsqueda exitosa (μs)')
     ax2.set_title('b) Tiempo de Búsqueda Exitosa')
@@ -55,4 +61,46 @@ def load_and_plot_results(filename='tree_benchmark_results.csv'):
     ax2.set_xscale('log')
     ax2.set_yscale('log')
 
+def plot_tail_latency(filename='tree_benchmark_stats.csv'):
+    """
+    Curvas de percentiles (p50 ... max) de operaciones sueltas: una gráfica
+    por operación, una curva por árbol, para el mayor n del fichero
+    """
+    try:
+        df = pd.read_csv(filename)
+    except FileNotFoundError:
+        print(f"Error: No se encontró el archivo {filename}")
+        return
+    if 'latency_p999_ns' not in df or df['latency_p999_ns'].isna().all():
+        print("Sin percentiles de latencia (¿se ejecutó con --no-latency?)")
+        return
+
+    n = df['n'].max()
+    df = df[df['n'] == n]
+    # Eje x en "nueves": p50 -> 2, p90 -> 10, p99 -> 100, p99.9 -> 1000
+    cols = ['latency_p50_ns', 'latency_p90_ns', 'latency_p99_ns', 'latency_p999_ns', 'latency_max_ns']
+    labels = ['p50', 'p90', 'p99', 'p99.9', 'max']
+    x = np.array([2, 10, 100, 1000, 10000])
+
+    ops = [op for op in ['insert', 'find_hit', 'find_miss', 'delete'] if op in df['op'].values]
+    fig, axes = plt.subplots(1, len(ops), figsize=(6 * len(ops), 5), squeeze=False)
+    fig.suptitle(f'Cola de latencia por operación (n = {n})', fontsize=16, fontweight='bold')
+    for ax, op in zip(axes[0], ops):
+        for _, row in df[df['op'] == op].iterrows():
+            ax.plot(x, row[cols].values.astype(float), 'o-', label=row['tree'], linewidth=2, markersize=5)
+        ax.set_xscale('log')
+        ax.set_yscale('log')
+        ax.set_xticks(x)
+        ax.set_xticklabels(labels)
+        ax.set_xlabel('Percentil')
+        ax.set_ylabel('Latencia (ns)')
+        ax.set_title(op)
+        ax.legend()
+        ax.grid(True, alpha=0.3)
+
+    plt.tight_layout()
+    plt.savefig('tail_latency.png', dpi=300, bbox_inches='tight')
+    plt.show()
+
 load_and_plot_results()
+plot_tail_latency()
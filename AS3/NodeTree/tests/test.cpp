@@ -1,70 +1,101 @@
 #include <iostream>
 #include <vector>
-#include <random>
 #include <chrono>
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <memory>
+#include <string>
 #include "nodeTree.h"
 #include "leafTree.h"
+#include "bPlusTree.h"
+#include "../../RBT/rb_leaf_tree.h"
+#include "../../RBT/rb_node_tree.h"
+#include "../../common/benchHarness.h"
+#include "../../common/workload.h"
 
 using namespace std;
 using namespace std::chrono;
 
+// Uso: ./test [opciones] [n_max]   (por defecto 100000; admite hasta 1e8)
+//      ./test --batch [n]           find_batch con lotes de 1 a 64 (ns por búsqueda)
+//      ./test --ycsb [n]            cargas YCSB A-F sobre n registros
+// Opciones: --trials N, --warmup N, --ops-per-sample N, --cpu K (-1: sin fijar),
+//           --order uniform|sequential|reverse|clustered|adversarial|zipfian
+//           (orden de inserción; zipfian inserta uniforme y sesga las búsquedas),
+//           --seed S, --counters (contadores hardware por operación en
+//           tree_benchmark_stats.csv y el JSON; ver common/perfCounters.h),
+//           --no-latency (sin p50/p90/p99/p99.9/max de operaciones sueltas;
+//           ver common/latencyHistogram.h)
+//   g++ -O2 -std=c++20 -I.. test.cpp -o test
+//
+// Escribe tree_benchmark_results.csv (medianas, lo que dibuja main.py),
+// tree_benchmark_stats.csv y tree_benchmark_results.json con todas las
+// estadísticas de cada (árbol, operación, n). Ver common/benchHarness.h.
+
 struct TestResult {
   int n;
   double nodeTree_insert_median;
   double leafTree_insert_median;
+  double bPlusTree_insert_median;
+  double rbLeafTree_insert_median;
   double nodeTree_successful_search_median;
   double leafTree_successful_search_median;
+  double bPlusTree_successful_search_median;
+  double rbLeafTree_successful_search_median;
   double nodeTree_unsuccessful_search_median;
   double leafTree_unsuccessful_search_median;
+  double bPlusTree_unsuccessful_search_median;
+  double rbLeafTree_unsuccessful_search_median;
+  double frozen_successful_search_median;
+  double frozen_unsuccessful_search_median;
   double nodeTree_delete_median;
   double leafTree_delete_median;
+  double bPlusTree_delete_median;
+  double rbLeafTree_delete_median;
 };
 
-// Función para calcular la mediana
-double calculateMedian(vector<double>& times) {
-  sort(times.begin(), times.end());
-  size_t size = times.size();
-  if (size % 2 == 0) {
-    return (times[size/2 - 1] + times[size/2]) / 2.0;
-  } else {
-    return times[size/2];
-  }
-}
+// Claves deterministas (ver common/workload.h)
+static workload wl;
+static keyOrder order = keyOrder::uniform;
 
-// Función para generar números aleatorios únicos
-vector<int> generateRandomArray(int n, int min_val = 1, int max_val = 1000000000) {
-  vector<int> arr;
-  random_device rd;
-  mt19937 gen(rd());
-  uniform_int_distribution<> dis(min_val, max_val);
-
-  while (arr.size() < n) {
-    int val = dis(gen);
-    if (find(arr.begin(), arr.end(), val) == arr.end()) {
-      arr.push_back(val);
-    }
-  }
-  return arr;
+// Evita que el compilador elimine las búsquedas cuyo resultado no se usa
+static volatile bool sink;
+
+static benchConfig config;
+static vector<benchRecord> records;
+
+// Guarda la fila completa y devuelve la mediana para la tabla y el CSV ancho
+double record(const string& tree, const char* op, size_t n, const benchStats& stats) {
+  records.push_back({tree, op, n, stats});
+  return stats.median;
 }
 
-// Función para generar valores que no están en el array
-vector<int> generateNonExistentValues(const vector<int>& existing, int count, int min_val = 1, int max_val = 1000000000) {
-  vector<int> non_existent;
-  random_device rd;
-  mt19937 gen(rd());
-  uniform_int_distribution<> dis(min_val, max_val);
-
-  while (non_existent.size() < count) {
-    int val = dis(gen);
-    if (find(existing.begin(), existing.end(), val) == existing.end() &&
-	find(non_existent.begin(), non_existent.end(), val) == non_existent.end()) {
-      non_existent.push_back(val);
-    }
-  }
-  return non_existent;
+struct opMedians {
+  double insert, hit, miss, del;
+};
+
+// Inserción sobre un árbol nuevo en cada ensayo, búsquedas sobre el árbol
+// lleno y borrado sobre uno reconstruido antes de cada ensayo
+template<typename Tree, typename Ins, typename Find, typename Del>
+opMedians benchTree(const string& name, const vector<int>& values, const vector<int>& hits,
+                    const vector<int>& nonExistent, const vector<int>& deleteOrder,
+                    Ins ins, Find find, Del del) {
+  unique_ptr<Tree> tree;
+  auto fresh = [&] { tree = make_unique<Tree>(); };
+  auto full = [&] {
+    fresh();
+    for (int v : values) ins(*tree, v);
+  };
+  auto nothing = [] {};
+  size_t n = values.size();
+
+  opMedians m;
+  m.insert = record(name, "insert", n, runBench(config, values, fresh, [&](int v) { ins(*tree, v); }));
+  m.hit = record(name, "find_hit", n, runBench(config, hits, nothing, [&](int v) { sink = find(*tree, v); }));
+  m.miss = record(name, "find_miss", n, runBench(config, nonExistent, nothing, [&](int v) { sink = find(*tree, v); }));
+  m.del = record(name, "delete", n, runBench(config, deleteOrder, full, [&](int v) { del(*tree, v); }));
+  return m;
 }
 
 TestResult runExperiment(int n) {
@@ -73,105 +104,220 @@ TestResult runExperiment(int n) {
 
   cout << "Running experiment for n = " << n << "..." << endl;
 
-  // 1. Crear árboles vacíos
-  nodeTree<int, int> nTree;
-  leafTree<int, int> lTree;
-
-  // 2. Generar array aleatorio
-  vector<int> values = generateRandomArray(n);
-
-  // 3. Test de inserción
-  vector<double> nodeInsertTimes, leafInsertTimes;
-
-  for (int val : values) {
-    // NodeTree insertion
-    auto start = high_resolution_clock::now();
-    nTree.insert(val, val);
-    auto end = high_resolution_clock::now();
-    nodeInsertTimes.push_back(duration_cast<nanoseconds>(end - start).count());
-
-    // LeafTree insertion
-    start = high_resolution_clock::now();
-    lTree.insert(val, val);
-    end = high_resolution_clock::now();
-    leafInsertTimes.push_back(duration_cast<nanoseconds>(end - start).count());
-  }
+  // Con zipfian se inserta en orden uniforme y se sesgan las búsquedas
+  bool skewedFinds = order == keyOrder::zipfian;
+  vector<int> values = wl.keys(n, skewedFinds ? keyOrder::uniform : order);
+  vector<int> hits = skewedFinds ? wl.keys(n, keyOrder::zipfian, 2) : values;
+  vector<int> nonExistent = wl.missing(n + 10);
+  vector<int> deleteOrder = wl.keys(n, keyOrder::uniform, 1);
+
+  // nodeTree y leafTree no se equilibran: con entradas ordenadas su altura
+  // es n y la inserción recursiva agotaría la pila
+  bool unbalancedOk = n <= 20000 || order == keyOrder::uniform ||
+    order == keyOrder::clustered || order == keyOrder::zipfian;
+  opMedians skipped = {NAN, NAN, NAN, NAN};
+  if (!unbalancedOk) cout << "  (nodeTree y leafTree omitidos: orden degenerado)" << endl;
+
+  auto ins = [](auto& t, int v) { t.insert(v, v); };
+  auto find = [](auto& t, int v) { return t.find(v) != nullptr; };
+  auto del = [](auto& t, int v) { t.deleteNode(v); };
+  opMedians nt = unbalancedOk
+    ? benchTree<nodeTree<int, int>>("nodeTree", values, hits, nonExistent, deleteOrder, ins, find, del)
+    : skipped;
+  opMedians lt = unbalancedOk
+    ? benchTree<leafTree<int, int>>("leafTree", values, hits, nonExistent, deleteOrder, ins, find, del)
+    : skipped;
+  opMedians bt = benchTree<bPlusTree<int, int>>("bPlusTree", values, hits, nonExistent, deleteOrder, ins, find, del);
+  opMedians rb = benchTree<RBLeafTree<int, int>>("rbLeafTree", values, hits, nonExistent, deleteOrder, ins, find,
+    [](auto& t, int v) { t.erase(v); });
+
+  result.nodeTree_insert_median = nt.insert;
+  result.leafTree_insert_median = lt.insert;
+  result.bPlusTree_insert_median = bt.insert;
+  result.rbLeafTree_insert_median = rb.insert;
+  result.nodeTree_successful_search_median = nt.hit;
+  result.leafTree_successful_search_median = lt.hit;
+  result.bPlusTree_successful_search_median = bt.hit;
+  result.rbLeafTree_successful_search_median = rb.hit;
+  result.nodeTree_unsuccessful_search_median = nt.miss;
+  result.leafTree_unsuccessful_search_median = lt.miss;
+  result.bPlusTree_unsuccessful_search_median = bt.miss;
+  result.rbLeafTree_unsuccessful_search_median = rb.miss;
+  result.nodeTree_delete_median = nt.del;
+  result.leafTree_delete_median = lt.del;
+  result.bPlusTree_delete_median = bt.del;
+  result.rbLeafTree_delete_median = rb.del;
+
+  // Búsquedas sobre la instantánea congelada (Eytzinger) del nodeTree
+  // (la base se inserta siempre en orden uniforme: con --order degenerado
+  // nodeTree tendría altura n)
+  nodeTree<int, int> base;
+  for (int v : skewedFinds || order == keyOrder::uniform ? values : wl.keys(n, keyOrder::uniform)) base.insert(v, v);
+  frozenTree<int, int> frozen = base.freeze();
+  auto nothing = [] {};
+  result.frozen_successful_search_median = record("frozen", "find_hit", n,
+    runBench(config, hits, nothing, [&](int v) { sink = frozen.find(v) != nullptr; }));
+  result.frozen_unsuccessful_search_median = record("frozen", "find_miss", n,
+    runBench(config, nonExistent, nothing, [&](int v) { sink = frozen.find(v) != nullptr; }));
 
-  result.nodeTree_insert_median = calculateMedian(nodeInsertTimes);
-  result.leafTree_insert_median = calculateMedian(leafInsertTimes);
+  return result;
+}
 
-  // 4. Test de búsqueda exitosa
-  vector<double> nodeSuccessfulSearchTimes, leafSuccessfulSearchTimes;
+// runBench mide llamadas a find_batch; cada una hace k búsquedas y los
+// tiempos se pasan a ns por búsqueda, como las filas find_hit/find_miss
+benchStats perLookup(benchStats s, size_t k) {
+  for (double* x : {&s.mean, &s.stddev, &s.median, &s.min, &s.max, &s.p5, &s.p25, &s.p75,
+                    &s.p95, &s.p99, &s.ciLow, &s.ciHigh,
+                    &s.counters.instructions, &s.counters.cycles, &s.counters.l1dMisses,
+                    &s.counters.llcMisses, &s.counters.dtlbMisses, &s.counters.branchMisses,
+                    &s.latency.p50, &s.latency.p90, &s.latency.p99, &s.latency.p999, &s.latency.max})
+    *x /= k;
+  return s;
+}
 
-  for (int val : values) {
-    // NodeTree search
-    auto start = high_resolution_clock::now();
-    nTree.find(val);
-    auto end = high_resolution_clock::now();
-    nodeSuccessfulSearchTimes.push_back(duration_cast<nanoseconds>(end - start).count());
+// find_batch con lotes de tamaño batch sobre probes. Devuelve Mops/s según
+// la mediana
+template<typename Tree>
+double batchLookups(const string& name, const Tree& tree, const vector<int>& probes, size_t batch) {
+  vector<typename Tree::find_result> out(batch);
+  vector<size_t> starts;
+  for (size_t i = 0; i + batch <= probes.size(); i += batch) starts.push_back(i);
+  benchStats s = runBench(config, starts, [] {}, [&](size_t i) {
+    tree.find_batch(span<const int>(probes.data() + i, batch), span<typename Tree::find_result>(out));
+    size_t hits = 0;
+    for (size_t j = 0; j < batch; j++) hits += out[j] != nullptr;
+    sink = hits > 0;
+  });
+  record(name, ("find_batch_" + to_string(batch)).c_str(), probes.size(), perLookup(s, batch));
+  return 1000 / records.back().stats.median;
+}
 
-    // LeafTree search
-    start = high_resolution_clock::now();
-    lTree.find(val);
-    end = high_resolution_clock::now();
-    leafSuccessfulSearchTimes.push_back(duration_cast<nanoseconds>(end - start).count());
-  }
+void runBatchExperiment(int n) {
+  cout << "Batch lookup benchmark, n = " << n << endl;
 
-  result.nodeTree_successful_search_median = calculateMedian(nodeSuccessfulSearchTimes);
-  result.leafTree_successful_search_median = calculateMedian(leafSuccessfulSearchTimes);
-
-  // 5. Test de búsqueda no exitosa
-  vector<int> nonExistent = generateNonExistentValues(values, n + 10);
-  vector<double> nodeUnsuccessfulSearchTimes, leafUnsuccessfulSearchTimes;
-
-  for (int val : nonExistent) {
-    // NodeTree search
-    auto start = high_resolution_clock::now();
-    nTree.find(val);
-    auto end = high_resolution_clock::now();
-    nodeUnsuccessfulSearchTimes.push_back(duration_cast<nanoseconds>(end - start).count());
-
-    // LeafTree search
-    start = high_resolution_clock::now();
-    lTree.find(val);
-    end = high_resolution_clock::now();
-    leafUnsuccessfulSearchTimes.push_back(duration_cast<nanoseconds>(end - start).count());
+  nodeTree<int, int> nTree;
+  RBNodeTree<int, int> rbnTree;
+  RBLeafTree<int, int> rblTree;
+
+  vector<int> values = wl.keys(n, keyOrder::uniform);
+  for (int v : values) {
+    nTree.insert(v, v);
+    rbnTree.insert(v, v);
+    rblTree.insert(v, v);
   }
 
-  result.nodeTree_unsuccessful_search_median = calculateMedian(nodeUnsuccessfulSearchTimes);
-  result.leafTree_unsuccessful_search_median = calculateMedian(leafUnsuccessfulSearchTimes);
-
-  // 6. Test de eliminación
-  vector<int> deleteOrder = values;
-  random_device rd;
-  mt19937 g(rd());
-  shuffle(deleteOrder.begin(), deleteOrder.end(), g);
-
-  vector<double> nodeDeleteTimes, leafDeleteTimes;
-
-  for (int val : deleteOrder) {
-    // NodeTree deletion
-    auto start = high_resolution_clock::now();
-    nTree.deleteNode(val);
-    auto end = high_resolution_clock::now();
-    nodeDeleteTimes.push_back(duration_cast<nanoseconds>(end - start).count());
-
-    // LeafTree deletion
-    start = high_resolution_clock::now();
-    lTree.deleteNode(val);
-    end = high_resolution_clock::now();
-    leafDeleteTimes.push_back(duration_cast<nanoseconds>(end - start).count());
+  // Mitad claves presentes y mitad ausentes, en orden aleatorio
+  vector<int> probes(values.begin(), values.begin() + n / 2);
+  vector<int> missing = wl.missing(n - n / 2);
+  probes.insert(probes.end(), missing.begin(), missing.end());
+  splitmix64 rng(7);
+  workload::shuffle(probes, rng);
+
+  cout << setw(8) << "batch" << setw(18) << "nodeTree Mops/s" << setw(18) << "RBNode Mops/s" << setw(18) << "RBLeaf Mops/s" << endl;
+  cout << string(62, '-') << endl;
+  for (size_t batch : {1, 2, 4, 8, 16, 32, 64}) {
+    double nt = batchLookups("nodeTree", nTree, probes, batch);
+    double rbn = batchLookups("rbNodeTree", rbnTree, probes, batch);
+    double rbl = batchLookups("rbLeafTree", rblTree, probes, batch);
+    cout << setw(8) << batch << setw(18) << fixed << setprecision(2) << nt
+      << setw(18) << rbn << setw(18) << rbl << endl;
   }
 
-  result.nodeTree_delete_median = calculateMedian(nodeDeleteTimes);
-  result.leafTree_delete_median = calculateMedian(leafDeleteTimes);
+  ofstream outFile("batch_benchmark_results.csv");
+  writeCsv(outFile, records);
+  cout << "\nResults saved to 'batch_benchmark_results.csv'" << endl;
+}
 
-  return result;
+// Una carga YCSB sobre un árbol recién cargado en cada ensayo. Los árboles
+// no tienen recorrido ordenado: un scan son scanLength búsquedas de claves
+// consecutivas. update, insert y la escritura de read-modify-write son
+// inserciones (todos los árboles sobrescriben el valor de una clave presente).
+template<typename Tree, typename Ins, typename Find>
+void ycsbTree(const string& name, char id, const vector<int>& load, const vector<operation>& ops,
+              Ins ins, Find find) {
+  unique_ptr<Tree> tree;
+  auto prepare = [&] {
+    tree = make_unique<Tree>();
+    for (int k : load) ins(*tree, k, k);
+  };
+  benchStats s = runBench(config, ops, prepare, [&](const operation& op) {
+    switch (op.type) {
+    case opType::read:
+      sink = find(*tree, op.key);
+      break;
+    case opType::update:
+    case opType::insert:
+      ins(*tree, op.key, op.key + 1);
+      break;
+    case opType::readModifyWrite:
+      sink = find(*tree, op.key);
+      ins(*tree, op.key, op.key + 1);
+      break;
+    case opType::scan:
+      for (uint32_t i = 0; i < op.scanLength; i++) sink = find(*tree, op.key + 2 * int(i));
+      break;
+    }
+  });
+  records.push_back({name, string("ycsb_") + id, load.size(), s});
+  cout << setw(10) << id << setw(14) << name << setw(14) << fixed << setprecision(3) << 1000 / s.mean
+    << setw(14) << setprecision(1) << s.mean << setw(22)
+    << "[" + to_string(s.ciLow).substr(0, 6) + ", " + to_string(s.ciHigh).substr(0, 6) + "]" << endl;
+}
+
+void runYcsbExperiment(int n) {
+  cout << "YCSB A-F: " << n << " registros cargados en orden uniforme, " << n << " operaciones" << endl;
+  vector<int> load = wl.keys(n, keyOrder::uniform);
+  auto ins = [](auto& t, int k, int v) { t.insert(k, v); };
+  auto find = [](auto& t, int k) { return t.find(k) != nullptr; };
+
+  cout << setw(10) << "workload" << setw(14) << "tree" << setw(14) << "Mops/s"
+    << setw(14) << "mean ns/op" << setw(22) << "95% CI" << endl;
+  for (char id : string("ABCDEF")) {
+    vector<operation> ops = wl.ycsb(id, n, n);
+    ycsbTree<nodeTree<int, int>>("nodeTree", id, load, ops, ins, find);
+    ycsbTree<leafTree<int, int>>("leafTree", id, load, ops, ins, find);
+    ycsbTree<bPlusTree<int, int>>("bPlusTree", id, load, ops, ins, find);
+    ycsbTree<RBLeafTree<int, int>>("rbLeafTree", id, load, ops, ins, find);
+    ycsbTree<RBNodeTree<int, int>>("rbNodeTree", id, load, ops, ins, find);
+  }
+
+  ofstream outFile("ycsb_benchmark_results.csv");
+  writeCsv(outFile, records);
+  cout << "\nResults saved to 'ycsb_benchmark_results.csv'" << endl;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
   vector<TestResult> results;
   vector<int> test_sizes;
+  int max_n = 0;
+  string mode;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--batch" || arg == "--ycsb") mode = arg;
+    else if (arg == "--trials" && hasValue) config.trials = stoi(argv[++i]);
+    else if (arg == "--warmup" && hasValue) config.warmup = stoi(argv[++i]);
+    else if (arg == "--ops-per-sample" && hasValue) config.batch = stoul(argv[++i]);
+    else if (arg == "--cpu" && hasValue) config.cpu = stoi(argv[++i]);
+    else if (arg == "--order" && hasValue) order = workload::parseOrder(argv[++i]);
+    else if (arg == "--seed" && hasValue) wl = workload(stoull(argv[++i]));
+    else if (arg == "--counters") config.counters = true;
+    else if (arg == "--no-latency") config.latency = false;
+    else max_n = (int)stod(arg);
+  }
+  bool pinned = pinToCore(config.cpu);
+  if (config.counters && !perfCounters::supported())
+    cout << "perf_event_open no disponible (¿perf_event_paranoid?): contadores a NAN" << endl;
+
+  if (mode == "--batch") {
+    runBatchExperiment(max_n ? max_n : 1000000);
+    return 0;
+  }
+  if (mode == "--ycsb") {
+    runYcsbExperiment(max_n ? max_n : 100000);
+    return 0;
+  }
+  if (!max_n) max_n = 100000;
 
   // Generar tamaños de prueba de 1 a 10^5
   for (int i = 1; i <= 10000; i *= 10) {
@@ -190,9 +336,18 @@ int main() {
     }
   }
 
+  for (int i = 1000000; i <= max_n && i <= 100000000; i *= 10) {
+    test_sizes.push_back(i);
+  }
+
   sort(test_sizes.begin(), test_sizes.end());
+  test_sizes.erase(unique(test_sizes.begin(), test_sizes.end()), test_sizes.end());
+  test_sizes.erase(remove_if(test_sizes.begin(), test_sizes.end(), [&](int n) { return n > max_n; }), test_sizes.end());
 
   cout << "Starting Tree Performance Benchmark..." << endl;
+  cout << "Trials: " << config.trials << " (+" << config.warmup << " warmup), "
+    << config.batch << " ops per sample, timer overhead " << timerOverhead() << " ns, "
+    << (pinned ? "pinned to CPU " + to_string(config.cpu) : string("not pinned")) << endl;
   cout << "Test sizes: ";
   for (int size : test_sizes) {
     cout << size << " ";
@@ -206,25 +361,41 @@ int main() {
 
   // Escribir resultados a archivo CSV
   ofstream outFile("tree_benchmark_results.csv");
-  outFile << "n,nodeTree_insert_median,leafTree_insert_median,";
-  outFile << "nodeTree_successful_search_median,leafTree_successful_search_median,";
-  outFile << "nodeTree_unsuccessful_search_median,leafTree_unsuccessful_search_median,";
-  outFile << "nodeTree_delete_median,leafTree_delete_median" << endl;
+  outFile << "n,nodeTree_insert_median,leafTree_insert_median,bPlusTree_insert_median,rbLeafTree_insert_median,";
+  outFile << "nodeTree_successful_search_median,leafTree_successful_search_median,bPlusTree_successful_search_median,rbLeafTree_successful_search_median,";
+  outFile << "nodeTree_unsuccessful_search_median,leafTree_unsuccessful_search_median,bPlusTree_unsuccessful_search_median,rbLeafTree_unsuccessful_search_median,";
+  outFile << "frozen_successful_search_median,frozen_unsuccessful_search_median,";
+  outFile << "nodeTree_delete_median,leafTree_delete_median,bPlusTree_delete_median,rbLeafTree_delete_median" << endl;
 
   for (const TestResult& result : results) {
     outFile << result.n << ",";
     outFile << result.nodeTree_insert_median << ",";
     outFile << result.leafTree_insert_median << ",";
+    outFile << result.bPlusTree_insert_median << ",";
+    outFile << result.rbLeafTree_insert_median << ",";
     outFile << result.nodeTree_successful_search_median << ",";
     outFile << result.leafTree_successful_search_median << ",";
+    outFile << result.bPlusTree_successful_search_median << ",";
+    outFile << result.rbLeafTree_successful_search_median << ",";
     outFile << result.nodeTree_unsuccessful_search_median << ",";
     outFile << result.leafTree_unsuccessful_search_median << ",";
+    outFile << result.bPlusTree_unsuccessful_search_median << ",";
+    outFile << result.rbLeafTree_unsuccessful_search_median << ",";
+    outFile << result.frozen_successful_search_median << ",";
+    outFile << result.frozen_unsuccessful_search_median << ",";
     outFile << result.nodeTree_delete_median << ",";
-    outFile << result.leafTree_delete_median << endl;
+    outFile << result.leafTree_delete_median << ",";
+    outFile << result.bPlusTree_delete_median << ",";
+    outFile << result.rbLeafTree_delete_median << endl;
   }
 
   outFile.close();
 
+  ofstream statsFile("tree_benchmark_stats.csv");
+  writeCsv(statsFile, records);
+  ofstream jsonFile("tree_benchmark_results.json");
+  writeJson(jsonFile, config, pinned, records);
+
   // Mostrar tabla de resultados
   cout << "\n" << setw(8) << "n" 
     << setw(15) << "NT Insert" 
@@ -235,8 +406,20 @@ int main() {
     << setw(15) << "LT Search-" 
     << setw(15) << "NT Delete" 
     << setw(15) << "LT Delete" << endl;
-
-  cout << string(120, '-') << endl;
+  cout << setw(8) << ""
+    << setw(15) << "B+ Insert"
+    << setw(15) << "RBL Insert"
+    << setw(15) << "B+ Search+"
+    << setw(15) << "RBL Search+"
+    << setw(15) << "B+ Search-"
+    << setw(15) << "RBL Search-"
+    << setw(15) << "B+ Delete"
+    << setw(15) << "RBL Delete" << endl;
+  cout << setw(8) << ""
+    << setw(15) << "Frz Search+"
+    << setw(15) << "Frz Search-" << endl;
+
+  cout << string(128, '-') << endl;
 
   for (const TestResult& result : results) {
     cout << setw(8) << result.n
@@ -248,9 +431,37 @@ int main() {
       << setw(15) << result.leafTree_unsuccessful_search_median
       << setw(15) << result.nodeTree_delete_median
       << setw(15) << result.leafTree_delete_median << endl;
+    cout << setw(8) << ""
+      << setw(15) << result.bPlusTree_insert_median
+      << setw(15) << result.rbLeafTree_insert_median
+      << setw(15) << result.bPlusTree_successful_search_median
+      << setw(15) << result.rbLeafTree_successful_search_median
+      << setw(15) << result.bPlusTree_unsuccessful_search_median
+      << setw(15) << result.rbLeafTree_unsuccessful_search_median
+      << setw(15) << result.bPlusTree_delete_median
+      << setw(15) << result.rbLeafTree_delete_median << endl;
+    cout << setw(8) << ""
+      << setw(15) << result.frozen_successful_search_median
+      << setw(15) << result.frozen_unsuccessful_search_median << endl;
+  }
+
+  // Cola de latencia del tamaño mayor (el resto, en tree_benchmark_stats.csv)
+  if (config.latency && !test_sizes.empty()) {
+    size_t n = size_t(test_sizes.back());
+    cout << "\nTail latency, n = " << n << " (ns, single ops)" << endl;
+    cout << setw(12) << "tree" << setw(12) << "op" << setw(10) << "p50" << setw(10) << "p90"
+      << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "max" << endl;
+    for (const benchRecord& r : records) {
+      if (r.n != n) continue;
+      const latencyPercentiles& l = r.stats.latency;
+      cout << setw(12) << r.tree << setw(12) << r.op << setprecision(0)
+        << setw(10) << l.p50 << setw(10) << l.p90 << setw(10) << l.p99
+        << setw(10) << l.p999 << setw(10) << l.max << endl;
+    }
   }
 
-  cout << "\nResults saved to 'tree_benchmark_results.csv'" << endl;
+  cout << "\nResults saved to 'tree_benchmark_results.csv' (medians), "
+    << "'tree_benchmark_stats.csv' and 'tree_benchmark_results.json'" << endl;
   cout << "Use the Python script to generate plots." << endl;
 
   return 0;
@@ -0,0 +1,66 @@
+// Suma de los valores de una ventana de claves: aggregate sobre los agregados
+// de sumAugment frente a recorrer la ventana acumulando (for_each_in_range
+// en el mismo árbol y std::map). ns por consulta.
+//   g++ -O2 -std=c++20 -pthread bench_aggregate.cpp -o bench_aggregate
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "rb_node_tree.h"
+
+using namespace std;
+using namespace std::chrono;
+
+typedef RBNodeTree<int, long long, noStats, sumAugment<long long>> SumTree;
+
+static volatile long long sink; // que el compilador no quite las consultas
+
+template <typename Query>
+double nsPerQuery(const vector<int> &starts, int w, Query query) {
+  long long sum = 0;
+  auto start = steady_clock::now();
+  for (int lo : starts) sum += query(lo, lo + w - 1);
+  double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  sink = sum;
+  return ns / starts.size();
+}
+
+int main() {
+  cout << setw(10) << "n" << setw(10) << "window" << setw(14) << "map scan"
+       << setw(14) << "rb scan" << setw(14) << "aggregate" << "   (ns/consulta)" << endl;
+  mt19937 rng(11);
+  for (int n : {10000, 100000, 1000000}) {
+    vector<pair<int, long long>> sorted(n);
+    for (int i = 0; i < n; i++) sorted[i] = {i, rng() % 1000};
+    SumTree tree;
+    tree.build_from_sorted(sorted.begin(), sorted.end());
+    map<int, long long> ref(sorted.begin(), sorted.end());
+
+    for (int w : {10, 1000, 100000}) {
+      if (w >= n) continue;
+      // menos consultas cuanto más ancha la ventana, para que los
+      // recorridos no se eternicen
+      vector<int> starts(max(100, 2000000 / w));
+      for (int &lo : starts) lo = int(rng() % (n - w));
+
+      double mapNs = nsPerQuery(starts, w, [&](int lo, int hi) {
+        long long s = 0;
+        for (auto it = ref.lower_bound(lo); it != ref.end() && it->first <= hi; ++it) s += it->second;
+        return s;
+      });
+      double scanNs = nsPerQuery(starts, w, [&](int lo, int hi) {
+        long long s = 0;
+        tree.for_each_in_range(lo, hi, [&](int, long long v) { s += v; });
+        return s;
+      });
+      double aggNs = nsPerQuery(starts, w, [&](int lo, int hi) { return tree.aggregate(lo, hi); });
+
+      cout << setw(10) << n << setw(10) << w << fixed << setprecision(1)
+           << setw(14) << mapNs << setw(14) << scanNs << setw(14) << aggNs << endl;
+    }
+  }
+  return 0;
+}
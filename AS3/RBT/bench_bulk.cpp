@@ -0,0 +1,49 @@
+// Carga masiva con build_from_sorted frente a n inserciones sucesivas.
+//   g++ -O2 -std=c++20 bench_bulk.cpp -o bench_bulk
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "rb_node_tree.h"
+#include "rb_leaf_tree.h"
+
+using namespace std;
+using namespace std::chrono;
+
+template <typename Tree>
+void run(const char *name, const vector<pair<int,int>> &sorted) {
+  double insertMs, bulkMs;
+  {
+    Tree *tree = new Tree();
+    auto start = steady_clock::now();
+    for (const auto &p : sorted) tree->insert(p.first, p.second);
+    insertMs = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+    delete tree;
+  }
+  {
+    Tree *tree = new Tree();
+    auto start = steady_clock::now();
+    tree->build_from_sorted(sorted.begin(), sorted.end());
+    bulkMs = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+    delete tree;
+  }
+
+  cout << setw(10) << sorted.size() << setw(14) << name
+       << setw(14) << fixed << setprecision(2) << insertMs
+       << setw(14) << bulkMs
+       << setw(10) << insertMs / bulkMs << "x" << endl;
+}
+
+int main() {
+  cout << setw(10) << "n" << setw(14) << "tree" << setw(14) << "insert ms"
+       << setw(14) << "bulk ms" << setw(11) << "speedup" << endl;
+  for (int n : {10000, 100000, 1000000, 10000000}) {
+    vector<pair<int,int>> sorted(n);
+    for (int i = 0; i < n; i++) sorted[i] = {2 * i, i};
+
+    run<RBNodeTree<int,int>>("RBNodeTree", sorted);
+    run<RBLeafTree<int,int>>("RBLeafTree", sorted);
+  }
+  return 0;
+}
@@ -0,0 +1,55 @@
+// Compara RBNodeTree (punteros) con RBCompactTree (índices de 32 bits):
+// bytes por clave y latencia de búsqueda.
+//   g++ -O2 -std=c++20 bench_compact.cpp -o bench_compact
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "rb_node_tree.h"
+#include "rb_compact_tree.h"
+#include "../common/memoryProbe.h"
+
+using namespace std;
+using namespace std::chrono;
+
+template <typename Tree>
+void run(const char *name, const vector<int> &keys, const vector<int> &probes) {
+  size_t before = heapInUse();
+  Tree *tree = new Tree();
+  for (int k : keys) tree->insert(k, k);
+  size_t bytes = heapInUse() - before;
+
+  long long sum = 0;
+  auto start = steady_clock::now();
+  for (int k : probes) {
+    auto n = tree->find(k);
+    sum += n ? n->val : 0;
+  }
+  double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count() / double(probes.size());
+
+  cout << setw(10) << keys.size() << setw(14) << name
+       << setw(14) << fixed << setprecision(2) << double(bytes) / keys.size()
+       << setw(14) << ns << "   (" << sum << ")" << endl;
+  delete tree;
+}
+
+int main() {
+  mt19937 gen(42);
+  cout << setw(10) << "n" << setw(14) << "tree" << setw(14) << "bytes/key" << setw(14) << "find ns/op" << endl;
+  for (int n : {10000, 100000, 1000000, 10000000}) {
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    for (int &k : keys) k *= 2;
+    shuffle(keys.begin(), keys.end(), gen);
+
+    vector<int> probes(keys);
+    shuffle(probes.begin(), probes.end(), gen);
+
+    run<RBNodeTree<int,int>>("pointer", keys, probes);
+    run<RBCompactTree<int,int>>("compact", keys, probes);
+  }
+  return 0;
+}
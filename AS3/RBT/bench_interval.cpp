@@ -0,0 +1,72 @@
+// Consultas de solapamiento en RBIntervalTree frente a recorrer todos los
+// intervalos. Inicios uniformes en [0, SPAN) y longitudes de hasta maxLen;
+// las ventanas consultadas tienen ancho w. us por consulta y resultados
+// medios por consulta.
+//   g++ -O2 -std=c++20 -pthread bench_interval.cpp -o bench_interval
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "rb_node_tree.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static const int SPAN = 1000000000;
+static volatile long long sink; // que el compilador no quite las consultas
+
+template <typename Query>
+double usPerQuery(const vector<int> &starts, Query query, long long &hits) {
+  hits = 0;
+  auto start = steady_clock::now();
+  for (int a : starts) hits += query(a);
+  double us = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1000.0;
+  sink = hits;
+  return us / starts.size();
+}
+
+int main() {
+  cout << setw(10) << "n" << setw(10) << "maxLen" << setw(12) << "w" << setw(12) << "hits"
+       << setw(14) << "brute us" << setw(14) << "tree us" << setw(11) << "speedup" << endl;
+  mt19937 rng(13);
+  for (int n : {100000, 1000000, 4000000}) {
+    for (int maxLen : {1000, 1000000}) {
+      vector<pair<int,int>> spans(n);
+      for (auto &span : spans) {
+        int s = int(rng() % SPAN);
+        span = {s, s + int(rng() % maxLen)};
+      }
+      // el árbol guarda cada intervalo una vez
+      sort(spans.begin(), spans.end());
+      spans.erase(unique(spans.begin(), spans.end()), spans.end());
+      RBIntervalTree<int,int> tree;
+      for (size_t i = 0; i < spans.size(); i++) tree.insert(spans[i], int(i));
+
+      for (int w : {0, 100000}) {
+        vector<int> queries(n >= 1000000 ? 20 : 100);
+        for (int &a : queries) a = int(rng() % SPAN);
+
+        long long bruteHits, treeHits;
+        double bruteUs = usPerQuery(queries, [&](int a) {
+          long long k = 0;
+          for (const auto &s : spans) k += s.first <= a + w && a <= s.second;
+          return k;
+        }, bruteHits);
+        double treeUs = usPerQuery(queries, [&](int a) {
+          long long k = 0;
+          tree.overlaps(a, a + w, [&](const pair<int,int> &, int) { k++; });
+          return k;
+        }, treeHits);
+
+        cout << setw(10) << n << setw(10) << maxLen << setw(12) << w << fixed << setprecision(1)
+             << setw(12) << double(treeHits) / queries.size()
+             << setw(14) << bruteUs << setw(14) << treeUs << setw(10) << bruteUs / treeUs << "x"
+             << (bruteHits != treeHits ? "  (distintos!)" : "") << endl;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+// Recorridos de rango en RBNodeTree (iterador y for_each_in_range) frente a
+// std::map: lower_bound desde una clave al azar y k claves seguidas.
+//   g++ -O2 -std=c++20 -pthread bench_range.cpp -o bench_range
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "rb_node_tree.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static const int SCANS = 2000;
+static volatile long long sink; // que el compilador no quite los recorridos
+
+// millones de claves recorridas por segundo
+template <typename Scan>
+double throughput(const vector<int> &starts, int k, Scan scan) {
+  long long sum = 0;
+  auto start = steady_clock::now();
+  for (int lo : starts) sum += scan(lo, k);
+  double s = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1e9;
+  sink = sum;
+  return double(starts.size()) * k / s / 1e6;
+}
+
+int main() {
+  cout << setw(10) << "n" << setw(8) << "k" << setw(14) << "map"
+       << setw(14) << "rb iter" << setw(14) << "rb visit" << "   (Mclaves/s)" << endl;
+  mt19937 rng(7);
+  for (int n : {10000, 100000, 1000000}) {
+    vector<pair<int,int>> sorted(n);
+    for (int i = 0; i < n; i++) sorted[i] = {2 * i, i};
+    RBNodeTree<int,int> tree;
+    tree.build_from_sorted(sorted.begin(), sorted.end());
+    map<int,int> ref(sorted.begin(), sorted.end());
+
+    for (int k : {10, 100, 1000, 10000}) {
+      if (k >= n) continue;
+      vector<int> starts(SCANS);
+      for (int &lo : starts) lo = int(rng() % (2 * (n - k)));
+
+      double mapRate = throughput(starts, k, [&](int lo, int k) {
+        long long s = 0;
+        auto it = ref.lower_bound(lo);
+        for (int i = 0; i < k; i++, ++it) s += it->second;
+        return s;
+      });
+      double iterRate = throughput(starts, k, [&](int lo, int k) {
+        long long s = 0;
+        auto it = tree.lower_bound(lo);
+        for (int i = 0; i < k; i++, ++it) s += it.value();
+        return s;
+      });
+      // las claves son pares: [lo, lo + 2k) contiene k claves
+      double visitRate = throughput(starts, k, [&](int lo, int k) {
+        long long s = 0;
+        tree.for_each_in_range(lo, lo + 2 * k - 1, [&](int, int v) { s += v; });
+        return s;
+      });
+
+      cout << setw(10) << n << setw(8) << k << fixed << setprecision(1)
+           << setw(14) << mapRate << setw(14) << iterRate << setw(14) << visitRate << endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Escalado de union_with / intersect_with / difference_with con el número de
+// hilos, para AVLTree (nodeTree) y RBNodeTree.
+//   g++ -O2 -std=c++20 -pthread bench_setops.cpp -o bench_setops
+//   ./bench_setops [n]     (n claves por árbol, 1e7 por defecto)
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "rb_node_tree.h"
+#include "../AVL/avl.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// a: múltiplos de 2, b: múltiplos de 3; comparten un tercio de las claves
+static vector<pair<int,int>> multiples(int n, int step) {
+  vector<pair<int,int>> v(n);
+  for (int i = 0; i < n; i++) v[i] = {i * step, i};
+  return v;
+}
+
+template <typename Tree, typename Op>
+double timeOp(const vector<pair<int,int>> &ka, const vector<pair<int,int>> &kb,
+              workStealingPool &pool, Op op, size_t &resultSize) {
+  Tree a, b;
+  a.build_from_sorted(ka.begin(), ka.end());
+  b.build_from_sorted(kb.begin(), kb.end());
+  auto start = steady_clock::now();
+  op(a, b, pool);
+  double ms = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+  resultSize = a.getSize();
+  return ms;
+}
+
+template <typename Tree>
+void run(const char *name, const vector<pair<int,int>> &ka, const vector<pair<int,int>> &kb,
+         const vector<unsigned> &threads) {
+  const char *ops[] = {"union", "intersect", "difference"};
+  for (int op = 0; op < 3; op++) {
+    double base = 0;
+    for (unsigned t : threads) {
+      workStealingPool pool(t);
+      size_t resultSize;
+      double ms = timeOp<Tree>(ka, kb, pool, [op](Tree &a, Tree &b, workStealingPool &p) {
+        if (op == 0) a.union_with(b, p);
+        else if (op == 1) a.intersect_with(b, p);
+        else a.difference_with(b, p);
+      }, resultSize);
+      if (t == 1) base = ms;
+      cout << setw(10) << name << setw(12) << ops[op] << setw(8) << t
+           << setw(12) << fixed << setprecision(1) << ms
+           << setw(10) << setprecision(2) << base / ms << "x"
+           << setw(12) << resultSize << endl;
+    }
+  }
+}
+
+// RBNodeTree no tiene getSize(); el adaptador mantiene la misma interfaz
+template <typename T, typename B>
+struct RBAdapter : RBNodeTree<T,B> {
+  size_t getSize() const { return this->size(); }
+  void union_with(RBAdapter &o, workStealingPool &p) { RBNodeTree<T,B>::union_with(o, p); }
+  void intersect_with(RBAdapter &o, workStealingPool &p) { RBNodeTree<T,B>::intersect_with(o, p); }
+  void difference_with(RBAdapter &o, workStealingPool &p) { RBNodeTree<T,B>::difference_with(o, p); }
+};
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? stoi(argv[1]) : 10000000;
+  vector<pair<int,int>> ka = multiples(n, 2), kb = multiples(n, 3);
+
+  vector<unsigned> threads;
+  unsigned maxThreads = max(1u, thread::hardware_concurrency());
+  for (unsigned t = 1; t < maxThreads; t *= 2) threads.push_back(t);
+  threads.push_back(maxThreads);
+
+  cout << "n = " << n << " por árbol" << endl;
+  cout << setw(10) << "tree" << setw(12) << "op" << setw(8) << "threads"
+       << setw(12) << "ms" << setw(11) << "speedup" << setw(12) << "size" << endl;
+  run<AVLTree<int,int>>("AVLTree", ka, kb, threads);
+  run<RBAdapter<int,int>>("RBNodeTree", ka, kb, threads);
+  return 0;
+}
@@ -0,0 +1,85 @@
+// RBLeafTree (pila de ancestros, puntero al padre) frente a RBTopDownTree
+// (una pasada descendente, sin padre): latencia y reservas por operación y
+// bytes de heap por clave (heapInUse, ver common/memoryProbe.h).
+//   g++ -O2 -std=c++20 bench_topdown.cpp -o bench_topdown
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "rb_leaf_tree.h"
+#include "rb_topdown_tree.h"
+#include "../common/memoryProbe.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Sólo cuenta las llamadas a operator new; los bytes los da heapInUse
+static size_t allocations = 0;
+
+void *operator new(size_t n) {
+  void *p = malloc(n ? n : 1);
+  if (!p) throw bad_alloc();
+  allocations++;
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+template <typename Tree>
+void run(const char *name, const vector<int> &keys, const vector<int> &order) {
+  double n = keys.size();
+  Tree *tree = new Tree();
+
+  size_t heapBefore = heapInUse(), allocBefore = allocations;
+  auto start = steady_clock::now();
+  for (int k : keys) tree->insert(k, k);
+  double insertNs = duration_cast<nanoseconds>(steady_clock::now() - start).count() / n;
+  double insertAllocs = (allocations - allocBefore) / n;
+  double bytes = (heapInUse() - heapBefore) / n;
+
+  long long found = 0;
+  start = steady_clock::now();
+  for (int k : order) found += tree->find(k) != nullptr;
+  double findNs = duration_cast<nanoseconds>(steady_clock::now() - start).count() / n;
+
+  allocBefore = allocations;
+  size_t erased = 0;
+  start = steady_clock::now();
+  for (int k : order) erased += tree->erase(k);
+  double eraseNs = duration_cast<nanoseconds>(steady_clock::now() - start).count() / n;
+  double eraseAllocs = (allocations - allocBefore) / n;
+
+  cout << setw(10) << keys.size() << setw(14) << name
+       << setw(12) << fixed << setprecision(1) << insertNs
+       << setw(12) << findNs
+       << setw(12) << eraseNs
+       << setw(14) << setprecision(2) << insertAllocs
+       << setw(14) << eraseAllocs
+       << setw(12) << bytes
+       << "   (" << found << "/" << erased << ")" << endl;
+  delete tree;
+}
+
+int main() {
+  mt19937 gen(42);
+  cout << setw(10) << "n" << setw(14) << "tree" << setw(12) << "insert ns"
+       << setw(12) << "find ns" << setw(12) << "erase ns" << setw(14) << "alloc/insert"
+       << setw(14) << "alloc/erase" << setw(12) << "bytes/key" << endl;
+  for (int n : {10000, 100000, 1000000, 10000000}) {
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), gen);
+    vector<int> order(keys);
+    shuffle(order.begin(), order.end(), gen);
+
+    run<RBLeafTree<int,int>>("stack", keys, order);
+    run<RBTopDownTree<int,int>>("top-down", keys, order);
+  }
+  return 0;
+}
@@ -0,0 +1,345 @@
+#ifndef RB_COMPACT_TREE_H
+#define RB_COMPACT_TREE_H
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../common/memoryUsage.h"
+
+// Variante compacta de RBNodeTree: los nodos viven en un vector contiguo y
+// los enlaces son índices de 32 bits. El bit alto del índice del padre guarda
+// el color, y el centinela nil es el índice 0.
+//
+// Los punteros devueltos por find apuntan dentro del vector: dejan de ser
+// válidos tras la siguiente inserción (el vector puede crecer) y al borrar
+// su clave. Los borrados no mueven los demás nodos. Con índices de 31 bits
+// caben hasta 2^31 - 1 nodos; insert lanza std::length_error al pasar de ahí.
+template <typename T, typename B>
+class RBCompactTree {
+  typedef uint32_t Idx;
+  static constexpr Idx NIL = 0;
+  static constexpr Idx RED_BIT = 0x80000000u;
+  static constexpr Idx IDX_MASK = 0x7fffffffu;
+
+ public:
+  struct Node {
+    T key;
+    B val;
+    Idx left;
+    Idx right;
+    Idx up; // padre | color
+
+    Node(const T &k = T(), const B &v = B(), Idx l = NIL, Idx r = NIL, Idx u = NIL)
+        : key(k), val(v), left(l), right(r), up(u) {}
+  };
+
+ private:
+  std::vector<Node> nodes;
+  Idx root;
+  Idx freeList; // huecos de erase, encadenados por left
+  size_t sz;
+
+ public:
+  RBCompactTree();
+
+  void insert(const T &key, const B &val);
+  bool erase (const T &key);
+  Node *find (const T &key);
+  const Node *find (const T &key) const;
+  size_t size() const { return sz; }
+
+  void reserve(size_t n) { nodes.reserve(n + 1); }
+  size_t capacityBytes() const { return nodes.capacity() * sizeof(Node); }
+  // un solo bloque: el nil, los huecos de erase y la capacidad libre del
+  // vector son sobrecoste
+  memoryUsage memory_usage() const {
+    memoryUsage m;
+    m.leafNodes = sz;
+    m.nodeBytes = sz * sizeof(Node);
+    m.overheadBytes = capacityBytes() - m.nodeBytes + sizeof(*this);
+    return m;
+  }
+
+ private:
+  Idx findIdx(const T &key) const;
+  Idx allocNode(const T &key, const B &val);
+  void freeNode(Idx x);
+
+  Idx &L(Idx x) { return nodes[x].left; }
+  Idx &R(Idx x) { return nodes[x].right; }
+  Idx P(Idx x) const { return nodes[x].up & IDX_MASK; }
+  void setP(Idx x, Idx p) { nodes[x].up = (nodes[x].up & RED_BIT) | p; }
+  bool isRed(Idx x) const { return (nodes[x].up & RED_BIT) != 0; }
+  void setRed(Idx x) { nodes[x].up |= RED_BIT; }
+  void setBlack(Idx x) { nodes[x].up &= IDX_MASK; }
+  void copyColor(Idx to, Idx from) { if (isRed(from)) setRed(to); else setBlack(to); }
+
+  void leftRotate (Idx x);
+  void rightRotate(Idx y);
+  void insertFix (Idx z);
+  void deleteFix (Idx x);
+  Idx minimum(Idx x) const;
+  void transplant (Idx u, Idx v);
+};
+
+// imp
+template <typename T, typename B>
+RBCompactTree<T,B>::RBCompactTree() : root(NIL), freeList(NIL), sz(0) {
+  nodes.emplace_back(); // nil: negro, enlaces a sí mismo
+}
+
+template <typename T, typename B>
+typename RBCompactTree<T,B>::Idx RBCompactTree<T,B>::allocNode(const T &key, const B &val) {
+  if (freeList != NIL) {
+    Idx x = freeList;
+    freeList = nodes[x].left;
+    nodes[x] = Node(key, val, NIL, NIL, RED_BIT);
+    return x;
+  }
+  if (nodes.size() > IDX_MASK) throw std::length_error("RBCompactTree: más de 2^31 - 1 nodos");
+  nodes.push_back(Node(key, val, NIL, NIL, RED_BIT));
+  return Idx(nodes.size() - 1);
+}
+
+template <typename T, typename B>
+void RBCompactTree<T,B>::freeNode(Idx x) {
+  nodes[x] = Node();
+  nodes[x].left = freeList;
+  freeList = x;
+}
+
+// rot
+template <typename T, typename B>
+void RBCompactTree<T,B>::leftRotate(Idx x) {
+  Idx y = R(x);
+  R(x) = L(y);
+  if (L(y) != NIL) setP(L(y), x);
+  Idx px = P(x);
+  setP(y, px);
+  if (px == NIL)
+    root = y;
+  else if (x == L(px))
+    L(px) = y;
+  else
+    R(px) = y;
+  L(y) = x;
+  setP(x, y);
+}
+
+template <typename T, typename B>
+void RBCompactTree<T,B>::rightRotate(Idx y) {
+  Idx x = L(y);
+  L(y) = R(x);
+  if (R(x) != NIL) setP(R(x), y);
+  Idx py = P(y);
+  setP(x, py);
+  if (py == NIL)
+    root = x;
+  else if (y == L(py))
+    L(py) = x;
+  else
+    R(py) = x;
+  R(x) = y;
+  setP(y, x);
+}
+
+// ins
+template <typename T, typename B>
+void RBCompactTree<T,B>::insert(const T &key, const B &val) {
+  Idx y = NIL;
+  Idx x = root;
+  while (x != NIL) {
+    y = x;
+    if (key < nodes[x].key) x = L(x);
+    else if (nodes[x].key < key) x = R(x);
+    else { nodes[x].val = val; return; }
+  }
+  Idx z = allocNode(key, val); // puede realojar el vector
+  setP(z, y);
+  if (y == NIL) root = z;
+  else if (key < nodes[y].key) L(y) = z;
+  else R(y) = z;
+
+  ++sz;
+  insertFix(z);
+}
+
+// reb
+template <typename T, typename B>
+void RBCompactTree<T,B>::insertFix(Idx z) {
+  while (isRed(P(z))) {
+    Idx p = P(z);
+    Idx g = P(p);
+    if (p == L(g)) {
+      Idx y = R(g);
+      if (isRed(y)) { // caso 1
+        setBlack(p);
+        setBlack(y);
+        setRed(g);
+        z = g;
+      } else {
+        if (z == R(p)) { // caso 2
+          z = p;
+          leftRotate(z);
+        }
+        setBlack(P(z)); // caso 3
+        setRed(P(P(z)));
+        rightRotate(P(P(z)));
+      }
+    } else { // simétrico
+      Idx y = L(g);
+      if (isRed(y)) {
+        setBlack(p);
+        setBlack(y);
+        setRed(g);
+        z = g;
+      } else {
+        if (z == L(p)) {
+          z = p;
+          rightRotate(z);
+        }
+        setBlack(P(z));
+        setRed(P(P(z)));
+        leftRotate(P(P(z)));
+      }
+    }
+  }
+  setBlack(root);
+}
+
+// sear
+template <typename T, typename B>
+typename RBCompactTree<T,B>::Idx RBCompactTree<T,B>::findIdx(const T &key) const {
+  Idx x = root;
+  while (x != NIL) {
+    const Node &n = nodes[x];
+    if (key == n.key) return x;
+    x = (key < n.key) ? n.left : n.right;
+  }
+  return NIL;
+}
+
+template <typename T, typename B>
+typename RBCompactTree<T,B>::Node* RBCompactTree<T,B>::find(const T &key) {
+  Idx x = findIdx(key);
+  return x == NIL ? nullptr : &nodes[x];
+}
+
+template <typename T, typename B>
+const typename RBCompactTree<T,B>::Node* RBCompactTree<T,B>::find(const T &key) const {
+  Idx x = findIdx(key);
+  return x == NIL ? nullptr : &nodes[x];
+}
+
+// erase
+template <typename T, typename B>
+bool RBCompactTree<T,B>::erase(const T &key) {
+  Idx z = findIdx(key);
+  if (z == NIL) return false;
+
+  Idx y = z;
+  Idx x;
+  bool yWasRed = isRed(y);
+
+  if (L(z) == NIL) {
+    x = R(z);
+    transplant(z, R(z));
+  } else if (R(z) == NIL) {
+    x = L(z);
+    transplant(z, L(z));
+  } else {
+    y = minimum(R(z));
+    yWasRed = isRed(y);
+    x = R(y);
+    if (P(y) == z) setP(x, y);
+    else {
+      transplant(y, R(y));
+      R(y) = R(z); setP(R(y), y);
+    }
+    transplant(z, y);
+    L(y) = L(z); setP(L(y), y);
+    copyColor(y, z);
+  }
+  freeNode(z);
+  --sz;
+
+  if (!yWasRed) deleteFix(x);
+  return true;
+}
+
+// reb
+template <typename T, typename B>
+void RBCompactTree<T,B>::deleteFix(Idx x) {
+  while (x != root && !isRed(x)) {
+    Idx p = P(x);
+    if (x == L(p)) {
+      Idx w = R(p);
+      if (isRed(w)) { // caso 1
+        setBlack(w);
+        setRed(p);
+        leftRotate(p);
+        w = R(p);
+      }
+      if (!isRed(L(w)) && !isRed(R(w))) { // caso 2
+        setRed(w);
+        x = p;
+      } else {
+        if (!isRed(R(w))) { // caso 3
+          setBlack(L(w));
+          setRed(w);
+          rightRotate(w);
+          w = R(p);
+        }
+        copyColor(w, p); // caso 4
+        setBlack(p);
+        setBlack(R(w));
+        leftRotate(p);
+        x = root;
+      }
+    } else { // simétrico
+      Idx w = L(p);
+      if (isRed(w)) {
+        setBlack(w);
+        setRed(p);
+        rightRotate(p);
+        w = L(p);
+      }
+      if (!isRed(R(w)) && !isRed(L(w))) {
+        setRed(w);
+        x = p;
+      } else {
+        if (!isRed(L(w))) {
+          setBlack(R(w));
+          setRed(w);
+          leftRotate(w);
+          w = L(p);
+        }
+        copyColor(w, p);
+        setBlack(p);
+        setBlack(L(w));
+        rightRotate(p);
+        x = root;
+      }
+    }
+  }
+  setBlack(x);
+}
+
+template <typename T, typename B>
+void RBCompactTree<T,B>::transplant(Idx u, Idx v) {
+  Idx pu = P(u);
+  if (pu == NIL) root = v;
+  else if (u == L(pu)) L(pu) = v;
+  else R(pu) = v;
+  setP(v, pu);
+}
+
+template <typename T, typename B>
+typename RBCompactTree<T,B>::Idx RBCompactTree<T,B>::minimum(Idx x) const {
+  while (nodes[x].left != NIL) x = nodes[x].left;
+  return x;
+}
+
+#endif /* RB_COMPACT_TREE_H */
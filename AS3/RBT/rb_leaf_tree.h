@@ -1,10 +1,22 @@
 #ifndef RB_LEAF_TREE_H
 #define RB_LEAF_TREE_H
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <span>
 #include <stack>
-
-template <typename T, typename B>
+#include <utility>
+#include "../common/memoryUsage.h"
+#include "../common/treeStats.h"
+
+// Las hojas guardan los pares y hacen de nil: siempre negras y sin contar en
+// la altura negra. Los nodos internos llevan la clave mínima de su subárbol
+// derecho y cumplen las reglas rojinegras habituales.
+// Las hojas forman además una lista doblemente enlazada en orden de clave, así
+// que un recorrido de k claves desde lower_bound cuesta O(log n + k).
+// Stats: noStats o countingStats (ver common/treeStats.h)
+template <typename T, typename B, typename Stats = noStats>
 class RBLeafTree {
   enum Color { RED, BLACK };
 
@@ -16,6 +28,8 @@ class RBLeafTree {
     Node *parent;
     bool leaf; 
     Color color;
+    Node *prev {nullptr}; // hojas vecinas; nulos en los nodos internos
+    Node *next {nullptr};
 
     Node(const T& k,
          const B& v,
@@ -29,19 +43,75 @@ class RBLeafTree {
 
   Node *root {nullptr};
   size_t sz {0};
+  [[no_unique_address]] mutable Stats stats;
 
  public:
+  typedef const B *find_result;
+  static constexpr size_t BATCH_GROUP = 16;
+
+  // recorre las hojas por sus enlaces; end() es nulo y --end() da la última
+  class iterator {
+    Node* x {nullptr};
+    const RBLeafTree* tree {nullptr};
+    friend class RBLeafTree;
+    iterator(Node* n, const RBLeafTree* t) : x{n}, tree{t} {}
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const T&, const B&>;
+    using reference = value_type;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    const T& key() const { return x->key; }
+    const B& value() const { return x->val; }
+    reference operator*() const { return {x->key, x->val}; }
+    iterator& operator++() { x = x->next; return *this; }
+    iterator& operator--() { x = x ? x->prev : tree->lastLeaf(); return *this; }
+    iterator operator++(int) { iterator t = *this; ++*this; return t; }
+    iterator operator--(int) { iterator t = *this; --*this; return t; }
+    bool operator==(const iterator& o) const { return x == o.x; }
+  };
+
   ~RBLeafTree() { destroy(root); }
 
   void insert(const T& key, const B& val);
   bool erase(const T& key);
   const B* find(const T& key) const;
+  // reemplaza el contenido por [first, last) ordenado y sin repetidos, O(n)
+  template <typename It>
+  void build_from_sorted(It first, It last);
+  // búsqueda de varias claves con precarga intercalada
+  void find_batch(std::span<const T> keys, std::span<find_result> out) const;
   size_t size() const { return sz; }
 
+  iterator begin() const { return {firstLeaf(), this}; }
+  iterator end() const { return {nullptr, this}; }
+  // primera clave >= key / > key
+  iterator lower_bound(const T& key) const;
+  iterator upper_bound(const T& key) const;
+
+  statsSnapshot getStats() const { return stats.snapshot(); }
+  void resetStats() { stats.reset(); }
+
+  // nodos con new/delete: sz hojas y sz - 1 internos
+  memoryUsage memory_usage() const {
+    memoryUsage m;
+    m.leafNodes = sz;
+    m.internalNodes = sz > 0 ? sz - 1 : 0;
+    size_t nodes = m.leafNodes + m.internalNodes;
+    m.nodeBytes = nodes * sizeof(Node);
+    m.overheadBytes = nodes * (heapBlockBytes(sizeof(Node)) - sizeof(Node)) + sizeof(*this);
+    return m;
+  }
+
  private:
   void destroy(Node* x);
 
   Node* findLeaf(const T& key) const;
+  Node* firstLeaf() const;
+  Node* lastLeaf() const;
+  static void unlinkLeaf(Node* x);
 
   void leftRotate (Node* x);
   void rightRotate(Node* y);
@@ -54,11 +124,14 @@ class RBLeafTree {
   }
 
   static Color nodeColor(Node* p) { return p ? p->color : BLACK; }
+
+  template <typename It>
+  Node* buildSorted(It& it, size_t n, int depth, int redDepth, Node* parent, Node*& tail);
 };
 
 // imp
-template <typename T, typename B>
-void RBLeafTree<T,B>::destroy(Node* x) {
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::destroy(Node* x) {
   if (!x) return;
   destroy(x->left);
   destroy(x->right);
@@ -66,25 +139,137 @@ void RBLeafTree<T,B>::destroy(Node* x) {
 }
 
 // find
-template <typename T, typename B>
-const B* RBLeafTree<T,B>::find(const T& key) const {
+template <typename T, typename B, typename Stats>
+const B* RBLeafTree<T,B,Stats>::find(const T& key) const {
+  stats.beginSearch();
   Node* leaf = findLeaf(key);
+  stats.endSearch();
+  if (leaf) stats.compare();
   return (leaf && leaf->key == key) ? &leaf->val : nullptr;
 }
 
-template <typename T, typename B>
-typename RBLeafTree<T,B>::Node* RBLeafTree<T,B>::findLeaf(const T& key) const {
+// grupos de BATCH_GROUP claves que bajan un nivel por ronda hasta su hoja
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::find_batch(std::span<const T> keys, std::span<find_result> out) const {
+  for (size_t base = 0; base < keys.size(); base += BATCH_GROUP) {
+    size_t m = std::min(BATCH_GROUP, keys.size() - base);
+    Node* cur[BATCH_GROUP];
+    for (size_t i = 0; i < m; i++) cur[i] = root;
+
+    size_t active = (root && !root->leaf) ? m : 0;
+    while (active > 0) {
+      active = 0;
+      for (size_t i = 0; i < m; i++) {
+        Node* x = cur[i];
+        if (x->leaf) continue;
+        x = (keys[base + i] < x->key) ? x->left : x->right;
+        cur[i] = x;
+        __builtin_prefetch(x);
+        if (!x->leaf) active++;
+      }
+    }
+
+    for (size_t i = 0; i < m; i++) {
+      Node* leaf = cur[i];
+      out[base + i] = (leaf && leaf->key == keys[base + i]) ? &leaf->val : nullptr;
+    }
+  }
+}
+
+template <typename T, typename B, typename Stats>
+typename RBLeafTree<T,B,Stats>::Node* RBLeafTree<T,B,Stats>::findLeaf(const T& key) const {
   Node* x = root;
-  while (x && !x->leaf)
+  while (x && !x->leaf) {
+    stats.visit();
+    stats.compare();
     x = (key < x->key) ? x->left : x->right;
+  }
+  if (x) stats.visit();
+  return x;
+}
+
+template <typename T, typename B, typename Stats>
+typename RBLeafTree<T,B,Stats>::Node* RBLeafTree<T,B,Stats>::firstLeaf() const {
+  Node* x = root;
+  while (x && !x->leaf) x = x->left;
+  return x;
+}
+
+template <typename T, typename B, typename Stats>
+typename RBLeafTree<T,B,Stats>::Node* RBLeafTree<T,B,Stats>::lastLeaf() const {
+  Node* x = root;
+  while (x && !x->leaf) x = x->right;
+  return x;
+}
+
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::unlinkLeaf(Node* x) {
+  if (x->prev) x->prev->next = x->next;
+  if (x->next) x->next->prev = x->prev;
+}
+
+// range
+// la hoja a la que baja findLeaf es la mayor clave <= key o, si no la hay,
+// la primera; en ambos casos lower_bound es ella o su siguiente
+template <typename T, typename B, typename Stats>
+typename RBLeafTree<T,B,Stats>::iterator RBLeafTree<T,B,Stats>::lower_bound(const T& key) const {
+  Node* leaf = findLeaf(key);
+  if (leaf) stats.compare();
+  if (leaf && leaf->key < key) leaf = leaf->next;
+  return {leaf, this};
+}
+
+template <typename T, typename B, typename Stats>
+typename RBLeafTree<T,B,Stats>::iterator RBLeafTree<T,B,Stats>::upper_bound(const T& key) const {
+  Node* leaf = findLeaf(key);
+  if (leaf) stats.compare();
+  if (leaf && !(key < leaf->key)) leaf = leaf->next;
+  return {leaf, this};
+}
+
+// bulk
+template <typename T, typename B, typename Stats>
+template <typename It>
+void RBLeafTree<T,B,Stats>::build_from_sorted(It first, It last) {
+  size_t n = std::distance(first, last);
+  destroy(root);
+  root = nullptr;
+  sz = n;
+  if (n == 0) return;
+  // las hojas quedan a profundidad d o d-1; los nodos internos a d-1 van en
+  // rojo para igualar los caminos
+  int redDepth = 0;
+  while ((size_t(1) << redDepth) < n) ++redDepth;
+  Node* tail = nullptr;
+  root = buildSorted(first, n, 0, redDepth - 1, nullptr, tail);
+  root->color = BLACK;
+}
+
+template <typename T, typename B, typename Stats>
+template <typename It>
+typename RBLeafTree<T,B,Stats>::Node* RBLeafTree<T,B,Stats>::buildSorted(It& it, size_t n, int depth, int redDepth, Node* parent, Node*& tail) {
+  if (n == 1) {
+    Node* leaf = new Node(it->first, it->second, nullptr, nullptr, parent, true, BLACK);
+    ++it;
+    // las hojas salen en orden: se encadenan tras la anterior
+    leaf->prev = tail;
+    if (tail) tail->next = leaf;
+    tail = leaf;
+    return leaf;
+  }
+  Node* x = new Node(T(), B(), nullptr, nullptr, parent, false, depth == redDepth ? RED : BLACK);
+  x->left = buildSorted(it, n / 2, depth + 1, redDepth, x, tail);
+  x->key = it->first; // primera clave del subárbol derecho
+  x->right = buildSorted(it, n - n / 2, depth + 1, redDepth, x, tail);
   return x;
 }
 
 // rot
-template <typename T, typename B>
-void RBLeafTree<T,B>::leftRotate(Node* x) {
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::leftRotate(Node* x) {
   Node* y = x->right;
   if (!y) return;                    
+  stats.rotate();
 
   // mover subárbol izquierdo de y a x‑right
   x->right = y->left;
@@ -105,10 +290,11 @@ void RBLeafTree<T,B>::leftRotate(Node* x) {
   x->parent = y;
 }
 
-template <typename T, typename B>
-void RBLeafTree<T,B>::rightRotate(Node* y) {
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::rightRotate(Node* y) {
   Node* x = y->left;
   if (!x) return;
+  stats.rotate();
 
   y->left = x->right;
   if (x->right)
@@ -127,8 +313,8 @@ void RBLeafTree<T,B>::rightRotate(Node* y) {
 }
 
 // insert
-template <typename T, typename B>
-void RBLeafTree<T,B>::insert(const T& key, const B& val) {
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::insert(const T& key, const B& val) {
   // caso 0: árbol vacío
   if (!root) {
     root = new Node(key, val, nullptr, nullptr, nullptr, true, BLACK);
@@ -141,29 +327,47 @@ void RBLeafTree<T,B>::insert(const T& key, const B& val) {
   Node* current = root;
   while (!current->leaf) {
     ancestors.push(current);
+    stats.visit();
+    stats.compare();
     current = (key < current->key) ? current->left : current->right;
   }
+  stats.visit();
 
   // clave ya existente -> actualizar valor 
+  stats.compare();
   if (current->key == key) {
     current->val = val;
     return;
   }
 
-  // dividir la hoja actual en dos hojas rojas 
-  Node* oldLeaf = new Node(current->key, current->val, nullptr, nullptr, current, true, RED);
-  Node* newLeaf = new Node(key, val, nullptr, nullptr, current, true, RED);
+  // dividir la hoja actual en dos hojas bajo un nodo interno rojo
+  Node* oldLeaf = new Node(current->key, current->val, nullptr, nullptr, current, true, BLACK);
+  Node* newLeaf = new Node(key, val, nullptr, nullptr, current, true, BLACK);
 
+  // oldLeaf ocupa el sitio de current en la lista y newLeaf va a su lado
+  oldLeaf->prev = current->prev;
+  oldLeaf->next = current->next;
+  if (oldLeaf->prev) oldLeaf->prev->next = oldLeaf;
+  if (oldLeaf->next) oldLeaf->next->prev = oldLeaf;
+
+  stats.compare();
   if (current->key < key) {
     current->left = oldLeaf;
     current->right = newLeaf;
     current->key = key; 
+    newLeaf->prev = oldLeaf;
+    newLeaf->next = oldLeaf->next;
   } else {
     current->left = newLeaf;
     current->right = oldLeaf;
+    newLeaf->prev = oldLeaf->prev;
+    newLeaf->next = oldLeaf;
   }
+  if (newLeaf->prev) newLeaf->prev->next = newLeaf;
+  if (newLeaf->next) newLeaf->next->prev = newLeaf;
 
   current->leaf = false;
+  current->prev = current->next = nullptr;
   current->color = RED; 
 
   insertFix(current, ancestors);
@@ -171,64 +375,71 @@ void RBLeafTree<T,B>::insert(const T& key, const B& val) {
 }
 
 // reb
-template <typename T, typename B>
-void RBLeafTree<T,B>::insertFix(Node* z, std::stack<Node*>& anc) {
-  while (!anc.empty() && z->parent && z->parent->color == RED) {
+// z es el nodo interno rojo recién creado; anc guarda sus ancestros con el
+// padre en la cima. Un padre rojo nunca es la raíz, así que tiene abuelo.
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::insertFix(Node* z, std::stack<Node*>& anc) {
+  while (!anc.empty()) {
+    Node* parent = anc.top();
+    anc.pop();
+    if (parent->color == BLACK) break;
+    stats.fixup();
     Node* upper = anc.top();
     anc.pop();
-    Node* other = (z->parent == upper->left) ? upper->right : upper->left;
+    Node* other = (parent == upper->left) ? upper->right : upper->left;
     // Caso 1: tío rojo -> cambiamos colores 
-    if (other && other->color == RED) {
-      z->parent->color = BLACK;
+    if (other->color == RED) {
+      stats.recolor(3);
+      parent->color = BLACK;
       other->color = BLACK;
       upper->color = RED;
       z = upper;
       continue;
     }
     // Casos 2‑3: tío negro 
-    if (z->parent == upper->left) {
-      if (z->parent->right && z->parent->right->color == RED) {
+    if (parent == upper->left) {
+      if (z == parent->right) {
         // caso 2.2
-        leftRotate(z->parent);
-        rightRotate(upper);
-        upper->left->color = BLACK;
-        upper->right->color = BLACK;
-        upper->color = RED;
-      } else {
-        // caso 2.1
-        rightRotate(upper);
-        upper->right->color = RED;
+        leftRotate(parent);
+        parent = z;
       }
+      // caso 2.1
+      rightRotate(upper);
     } else { // simétrico 
-      if (z->parent->left && z->parent->left->color == RED) {
+      if (z == parent->left) {
         // caso 3.2
-        rightRotate(z->parent);
-        leftRotate(upper);
-        upper->right->color = BLACK;
-        upper->left->color = BLACK;
-        upper->color = RED;
-      } else {
-        // caso 3.1
-        leftRotate(upper);
-        upper->left->color = RED;
+        rightRotate(parent);
+        parent = z;
       }
+      // caso 3.1
+      leftRotate(upper);
     }
+    stats.recolor(2);
+    parent->color = BLACK;
+    upper->color = RED;
     break; 
   }
-  if (root) root->color = BLACK;
+  if (root) {
+    stats.recolor(root->color == RED);
+    root->color = BLACK;
+  }
 }
 
 // erase
-template <typename T, typename B>
-bool RBLeafTree<T,B>::erase(const T& key) {
+template <typename T, typename B, typename Stats>
+bool RBLeafTree<T,B,Stats>::erase(const T& key) {
   if (!root) return false;
 
   std::stack<Node*> path;
   Node* current = root;
   while (!current->leaf) {
     path.push(current);
+    stats.visit();
+    stats.compare();
     current = (key < current->key) ? current->left : current->right;
   }
+  stats.visit();
+  stats.compare();
   if (current->key != key) return false;
 
   if (current == root) {
@@ -251,29 +462,35 @@ bool RBLeafTree<T,B>::erase(const T& key) {
   else
     upper->parent->right = other;
 
-  bool siblingWasRed = (other && other->color == RED);
+  // si upper era rojo los caminos no pierden ningún negro
+  bool upperWasRed = upper->color == RED;
+  bool siblingWasRed = other->color == RED;
 
+  unlinkLeaf(current);
   delete current;
   delete upper;
   --sz;
 
+  if (upperWasRed) return true;
+
   if (siblingWasRed) {
+    stats.recolor();
     other->color = BLACK;   
     return true;
   }
 
-  if (other)
-    deleteFix(other);      
+  deleteFix(other);      
 
   return true;
 }
 
 // reb
-template <typename T, typename B>
-void RBLeafTree<T,B>::deleteFix(Node* current) {
+template <typename T, typename B, typename Stats>
+void RBLeafTree<T,B,Stats>::deleteFix(Node* current) {
   while (current && current != root && nodeColor(current) == BLACK) {
     Node* parent = current->parent;
     if (!parent) break;
+    stats.fixup();
 
     bool isLeft = (current == parent->left);
     Node* sib   = isLeft ? parent->right : parent->left;
@@ -285,6 +502,7 @@ void RBLeafTree<T,B>::deleteFix(Node* current) {
 
     // Caso 1: hermano rojo 
     if (sib->color == RED) {
+      stats.recolor(2);
       sib->color = BLACK;
       parent->color = RED;
       if (isLeft)  leftRotate(parent);
@@ -298,6 +516,7 @@ void RBLeafTree<T,B>::deleteFix(Node* current) {
 
     // Caso 2: hermano negro con ambos hijos negros 
     if (nodeColor(sib->left) == BLACK && nodeColor(sib->right) == BLACK) {
+      stats.recolor();
       sib->color = RED;
       current = parent; // subir doble‑negro al padre
       continue;
@@ -305,12 +524,14 @@ void RBLeafTree<T,B>::deleteFix(Node* current) {
 
     // Caso 3: hermano negro con hijo cercano rojo y lejano negro 
     if (isLeft && nodeColor(sib->right) == BLACK && nodeColor(sib->left) == RED) {
+      stats.recolor(2);
       sib->left->color = BLACK;
       sib->color = RED;
       rightRotate(sib);
       sib = parent->right;
     }
     else if (!isLeft && nodeColor(sib->left) == BLACK && nodeColor(sib->right) == RED) {
+      stats.recolor(2);
       sib->right->color = BLACK;
       sib->color = RED;
       leftRotate(sib);
@@ -318,6 +539,8 @@ void RBLeafTree<T,B>::deleteFix(Node* current) {
     }
 
     // Caso 4: hermano negro con hijo lejano rojo 
+    Node* far = isLeft ? sib->right : sib->left;
+    stats.recolor((sib->color != parent->color) + (parent->color != BLACK) + (nodeColor(far) == RED));
     sib->color = parent->color;
     parent->color = BLACK;
     if (isLeft) {
@@ -329,8 +552,14 @@ void RBLeafTree<T,B>::deleteFix(Node* current) {
     }
     break; 
   }
-  if (current) current->color = BLACK;
-  if (root) root->color = BLACK;
+  if (current) {
+    stats.recolor(current->color == RED);
+    current->color = BLACK;
+  }
+  if (root) {
+    stats.recolor(root->color == RED);
+    root->color = BLACK;
+  }
 }
 
 #endif /* RB_LEAF_TREE_H */
@@ -1,9 +1,24 @@
 #ifndef RB_NODE_TREE_H
 #define RB_NODE_TREE_H
 
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <span>
 #include <utility>
-template <typename T, typename B>
+#include <vector>
+#include "../common/frozenTree.h"
+#include "../common/memoryUsage.h"
+#include "../common/treeAugment.h"
+#include "../common/treeStats.h"
+#include "../common/workStealingPool.h"
+
+// Stats: noStats o countingStats (ver common/treeStats.h)
+// Augment: agregado por subárbol para aggregate(lo, hi), p. ej. sumAugment<B>
+// (ver common/treeAugment.h). Con uno activo los valores se cambian con
+// insert: escribir en find(key)->val deja el agregado desfasado.
+template <typename T, typename B, typename Stats = noStats, typename Augment = noAugment>
 class RBNodeTree {
   enum Color { RED, BLACK };
 
@@ -14,40 +29,179 @@ class RBNodeTree {
     Node *left;
     Node *right;
     Node *parent;
+    [[no_unique_address]] typename Augment::value_type agg;
 
     Node(const T &k = T(), const B &v = B(), Color c = RED,
          Node *l = nullptr, Node *r = nullptr, Node *p = nullptr)
-        : key(k), val(v), color(c), left(l), right(r), parent(p) {}
+        : key(k), val(v), color(c), left(l), right(r), parent(p), agg(Augment::identity()) {}
   };
 
   Node *root; 
   Node *nil; 
   size_t sz;
+  [[no_unique_address]] mutable Stats stats;
 
  public:
+  typedef Node *find_result;
+  static constexpr size_t BATCH_GROUP = 16;
+
+  // inorden con los punteros al padre: cada paso es O(1) amortizado; end()
+  // es nil y --end() da el máximo
+  class iterator {
+    Node *x {nullptr};
+    const RBNodeTree *tree {nullptr};
+    friend class RBNodeTree;
+    iterator(Node *n, const RBNodeTree *t) : x{n}, tree{t} {}
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const T&, const B&>;
+    using reference = value_type;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    const T &key() const { return x->key; }
+    const B &value() const { return x->val; }
+    reference operator*() const { return {x->key, x->val}; }
+    iterator &operator++() { x = tree->successor(x); return *this; }
+    iterator &operator--() { x = x == tree->nil ? tree->maximum(tree->root) : tree->predecessor(x); return *this; }
+    iterator operator++(int) { iterator t = *this; ++*this; return t; }
+    iterator operator--(int) { iterator t = *this; --*this; return t; }
+    bool operator==(const iterator &o) const { return x == o.x; }
+  };
+
   RBNodeTree();
   ~RBNodeTree();
 
   void insert(const T &key, const B &val);
   bool erase (const T &key);
   Node *find (const T &key) const;
+  // reemplaza el contenido por [first, last) ordenado y sin repetidos, O(n)
+  template <typename It>
+  void build_from_sorted(It first, It last);
+  // búsqueda de varias claves con precarga intercalada
+  void find_batch(std::span<const T> keys, std::span<find_result> out) const;
   size_t size() const { return sz; }
 
+  iterator begin() const { return {root == nil ? nil : minimum(root), this}; }
+  iterator end() const { return {nil, this}; }
+  // primera clave >= key / > key
+  iterator lower_bound(const T &key) const;
+  iterator upper_bound(const T &key) const;
+  std::pair<iterator, iterator> equal_range(const T &key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  // f(key, val) para cada clave de [lo, hi] en orden, sin subir por el padre
+  template <typename F>
+  void for_each_in_range(const T &lo, const T &hi, F &&f) const;
+  // combine de los pares de [lo, hi] en orden de clave, O(log n)
+  typename Augment::value_type aggregate(const T &lo, const T &hi) const requires Augment::enabled;
+
+  // Sólo con intervalAugment (RBIntervalTree): f(key, val) para cada
+  // intervalo que corta [a, b] / contiene point, en orden de inicio.
+  // O(log n + k log(n / k)) para k resultados, no O(log n + k): con sólo el
+  // mayor fin por subárbol, entre dos resultados puede haber que bajar por
+  // ramas podadas. Es O(log n + k) si los k quedan juntos en orden de inicio.
+  typedef typename Augment::value_type endpoint;
+  template <typename F>
+  void overlaps(const endpoint &a, const endpoint &b, F &&f) const requires Augment::interval;
+  template <typename F>
+  void stab(const endpoint &point, F &&f) const requires Augment::interval { overlaps(point, point, f); }
+
+  statsSnapshot getStats() const { return stats.snapshot(); }
+  void resetStats() { stats.reset(); }
+
+  // nodos con new/delete: sz hojas y el centinela nil, que cuenta como
+  // sobrecoste junto con la cabecera y el redondeo de malloc
+  memoryUsage memory_usage() const {
+    memoryUsage m;
+    m.leafNodes = sz;
+    m.nodeBytes = sz * sizeof(Node);
+    m.overheadBytes = sz * (heapBlockBytes(sizeof(Node)) - sizeof(Node)) +
+                      heapBlockBytes(sizeof(Node)) + sizeof(*this);
+    return m;
+  }
+
+  // instantánea de sólo lectura en orden de Eytzinger, O(n)
+  frozenTree<T,B> freeze() const;
+
+  // conjuntos con other (queda vacío), divide y vencerás con join en paralelo;
+  // en la unión gana el valor de other, la intersección conserva los propios.
+  // Con other == *this la unión y la intersección no hacen nada y la
+  // diferencia vacía el árbol
+  void union_with     (RBNodeTree &other, workStealingPool &pool = workStealingPool::global());
+  void intersect_with (RBNodeTree &other, workStealingPool &pool = workStealingPool::global());
+  void difference_with(RBNodeTree &other, workStealingPool &pool = workStealingPool::global());
+
   Node * _test_root() const { return root; }
 
  private:
   void destroy(Node *x);
+  Node *lookup(const T &key) const;
   void leftRotate (Node *x);
   void rightRotate(Node *y);
   void insertFix (Node *z);
   void deleteFix (Node *x);
   Node *minimum(Node *x) const;
+  Node *maximum(Node *x) const;
+  // recalcula el agregado de x a partir de sus hijos; nil guarda el neutro
+  void pull(Node *x) {
+    if constexpr (Augment::enabled)
+      x->agg = Augment::combine(Augment::combine(x->left->agg, Augment::lift(x->key, x->val)), x->right->agg);
+  }
+  void pullPath(Node *x) {
+    if constexpr (Augment::enabled)
+      for (; x != nil; x = x->parent) pull(x);
+  }
+  Node *successor(Node *x) const;
+  Node *predecessor(Node *x) const;
+  template <typename F>
+  void rangeVisit(Node *x, const T &lo, const T &hi, F &f) const;
+  template <typename F>
+  void overlapVisit(Node *x, const endpoint &a, const endpoint &b, F &f) const;
   void transplant (Node *u, Node *v);
+  void collectInorder(Node *x, std::vector<T> &keys, std::vector<B> &vals) const;
+  template <typename It>
+  Node *buildSorted(It &it, size_t n, int depth, int redDepth, Node *parent);
+
+  // join/split: subárbol suelto con su altura negra (nodos negros hasta nil)
+  struct Sub {
+    Node *root;
+    int bh;
+  };
+  struct setOpContext {
+    workStealingPool &pool;
+    int forkDepth;
+  };
+  setOpContext *setOp = nullptr;
+
+  Sub child(Sub t, bool left) const {
+    return Sub{left ? t.root->left : t.root->right, t.bh - (t.root->color == BLACK)};
+  }
+  void setLeft (Node *x, Node *c) { x->left = c;  if (c != nil) c->parent = x; }
+  void setRight(Node *x, Node *c) { x->right = c; if (c != nil) c->parent = x; }
+  int blackHeight(Node *x) const;
+  Node *rotateLeftSub (Node *x);
+  Node *rotateRightSub(Node *y);
+  Node *joinRight(Node *l, int bhL, Node *m, Node *r, int bhR);
+  Node *joinLeft (Node *l, int bhL, Node *m, Node *r, int bhR);
+  Sub join (Sub l, Node *m, Sub r);
+  Sub join2(Sub l, Sub r);
+  Node *split(Sub t, const T &key, Sub &l, Sub &r);
+  Sub unionRB     (Sub a, Sub b, int depth, size_t &repeated);
+  Sub intersectRB (Sub a, Sub b, int depth, size_t &common);
+  Sub differenceRB(Sub a, Sub b, int depth, size_t &removed);
+  void destroyPar(Node *x, int depth);
+  void relink(Node *x, Node *oldNil, int depth);
+  template <typename F, typename G>
+  void forkJoin(int depth, F &&f, G &&g);
+  template <typename Op>
+  void runSetOp(RBNodeTree &other, workStealingPool &pool, Op op);
 };
 
 // imp
-template <typename T, typename B>
-RBNodeTree<T,B>::RBNodeTree() {
+template <typename T, typename B, typename Stats, typename Augment>
+RBNodeTree<T,B,Stats,Augment>::RBNodeTree() {
   nil = new Node();
   nil->color = BLACK;
   nil->left = nil->right = nil->parent = nil;
@@ -55,14 +209,14 @@ RBNodeTree<T,B>::RBNodeTree() {
   sz = 0;
 }
 
-template <typename T, typename B>
-RBNodeTree<T,B>::~RBNodeTree() {
+template <typename T, typename B, typename Stats, typename Augment>
+RBNodeTree<T,B,Stats,Augment>::~RBNodeTree() {
   destroy(root);
   delete nil;
 }
 
-template <typename T, typename B>
-void RBNodeTree<T,B>::destroy(Node *x) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::destroy(Node *x) {
   if (x == nil) return;
   destroy(x->left);
   destroy(x->right);
@@ -70,8 +224,9 @@ void RBNodeTree<T,B>::destroy(Node *x) {
 }
 
 // rot
-template <typename T, typename B>
-void RBNodeTree<T,B>::leftRotate(Node *x) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::leftRotate(Node *x) {
+  stats.rotate();
   Node *y = x->right;
   x->right = y->left;
   if (y->left != nil) y->left->parent = x;
@@ -84,10 +239,13 @@ void RBNodeTree<T,B>::leftRotate(Node *x) {
     x->parent->right = y;
   y->left = x;
   x->parent = y;
+  pull(x);
+  pull(y);
 }
 
-template <typename T, typename B>
-void RBNodeTree<T,B>::rightRotate(Node *y) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::rightRotate(Node *y) {
+  stats.rotate();
   Node *x = y->left;
   y->left = x->right;
   if (x->right != nil) x->right->parent = y;
@@ -100,36 +258,45 @@ void RBNodeTree<T,B>::rightRotate(Node *y) {
     y->parent->right = x;
   x->right = y;
   y->parent = x;
+  pull(y);
+  pull(x);
 }
 
 // ins
-template <typename T, typename B>
-void RBNodeTree<T,B>::insert(const T &key, const B &val) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::insert(const T &key, const B &val) {
   Node *z = new Node(key,val,RED,nil,nil,nil);
   Node *y = nil;
   Node *x = root;
   while (x != nil) {
     y = x;
+    stats.visit();
+    stats.compare();
     if (key < x->key) x = x->left;
-    else if (x->key < key) x = x->right;
-    else { x->val = val; delete z; return; }
+    else if (x->key < key) { stats.compare(); x = x->right; }
+    else { stats.compare(); x->val = val; delete z; pullPath(x); return; }
   }
   z->parent = y;
+  if (y != nil) stats.compare();
   if (y == nil) root = z;
   else if (key < y->key) y->left = z;
   else y->right = z;
 
   ++sz;
+  // agregados al día antes de reequilibrar; las rotaciones los conservan
+  pullPath(z);
   insertFix(z);
 }
 
 // reb
-template <typename T, typename B>
-void RBNodeTree<T,B>::insertFix(Node *z) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::insertFix(Node *z) {
   while (z->parent->color == RED) {
+    stats.fixup();
     if (z->parent == z->parent->parent->left) {
       Node *y = z->parent->parent->right; 
       if (y->color == RED) { // caso 1
+        stats.recolor(3);
         z->parent->color = BLACK;
         y->color = BLACK;
         z->parent->parent->color = RED;
@@ -139,6 +306,7 @@ void RBNodeTree<T,B>::insertFix(Node *z) {
           z = z->parent;
           leftRotate(z);
         }
+        stats.recolor(2);
         z->parent->color = BLACK; // caso 3
         z->parent->parent->color = RED;
         rightRotate(z->parent->parent);
@@ -146,6 +314,7 @@ void RBNodeTree<T,B>::insertFix(Node *z) {
     } else { // simétrico
       Node *y = z->parent->parent->left;
       if (y->color == RED) {
+        stats.recolor(3);
         z->parent->color = BLACK;
         y->color = BLACK;
         z->parent->parent->color = RED;
@@ -155,30 +324,98 @@ void RBNodeTree<T,B>::insertFix(Node *z) {
           z = z->parent;
           rightRotate(z);
         }
+        stats.recolor(2);
         z->parent->color = BLACK;
         z->parent->parent->color = RED;
         leftRotate(z->parent->parent);
       }
     }
   }
+  stats.recolor(root->color == RED);
   root->color = BLACK;
 }
 
 // sear
-template <typename T, typename B>
-typename RBNodeTree<T,B>::Node* RBNodeTree<T,B>::find(const T &key) const {
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::find(const T &key) const {
+  stats.beginSearch();
+  Node *x = lookup(key);
+  stats.endSearch();
+  return x;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::lookup(const T &key) const {
   Node *x = root;
   while (x != nil) {
+    stats.visit();
+    stats.compare();
     if (key == x->key) return x;
+    stats.compare();
     x = (key < x->key) ? x->left : x->right;
   }
   return nullptr;
 }
 
+// grupos de BATCH_GROUP claves que bajan un nivel por ronda
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::find_batch(std::span<const T> keys, std::span<find_result> out) const {
+  for (size_t base = 0; base < keys.size(); base += BATCH_GROUP) {
+    size_t m = std::min(BATCH_GROUP, keys.size() - base);
+    Node *cur[BATCH_GROUP];
+    for (size_t i = 0; i < m; i++) {
+      cur[i] = root;
+      out[base + i] = nullptr;
+    }
+
+    size_t active = root != nil ? m : 0;
+    while (active > 0) {
+      active = 0;
+      for (size_t i = 0; i < m; i++) {
+        Node *x = cur[i];
+        if (x == nil) continue;
+        const T &key = keys[base + i];
+        if (key == x->key) { out[base + i] = x; cur[i] = nil; continue; }
+        x = (key < x->key) ? x->left : x->right;
+        cur[i] = x;
+        if (x != nil) { __builtin_prefetch(x); active++; }
+      }
+    }
+  }
+}
+
+// bulk
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename It>
+void RBNodeTree<T,B,Stats,Augment>::build_from_sorted(It first, It last) {
+  size_t n = std::distance(first, last);
+  destroy(root);
+  // el nivel más profundo (floor(log2 n)) va en rojo; el resto en negro
+  int redDepth = 0;
+  while ((size_t(2) << redDepth) <= n) ++redDepth;
+  root = buildSorted(first, n, 0, redDepth, nil);
+  root->color = BLACK;
+  sz = n;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename It>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::buildSorted(It &it, size_t n, int depth, int redDepth, Node *parent) {
+  if (n == 0) return nil;
+  Node *x = new Node(T(), B(), depth == redDepth ? RED : BLACK, nil, nil, parent);
+  x->left = buildSorted(it, n / 2, depth + 1, redDepth, x);
+  x->key = it->first;
+  x->val = it->second;
+  ++it;
+  x->right = buildSorted(it, n - n / 2 - 1, depth + 1, redDepth, x);
+  pull(x);
+  return x;
+}
+
 // erase
-template <typename T, typename B>
-bool RBNodeTree<T,B>::erase(const T &key) {
-  Node *z = find(key);
+template <typename T, typename B, typename Stats, typename Augment>
+bool RBNodeTree<T,B,Stats,Augment>::erase(const T &key) {
+  Node *z = lookup(key);
   if (!z) return false;
 
   Node *y = z;
@@ -207,32 +444,40 @@ bool RBNodeTree<T,B>::erase(const T &key) {
   delete z;
   --sz;
 
+  // x->parent es el nodo más bajo que ha cambiado de hijos (transplant lo
+  // fija también cuando x es nil)
+  pullPath(x->parent);
   if (y_original == BLACK) deleteFix(x);
   return true;
 }
 
 // reb
-template <typename T, typename B>
-void RBNodeTree<T,B>::deleteFix(Node *x) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::deleteFix(Node *x) {
   while (x != root && x->color == BLACK) {
+    stats.fixup();
     if (x == x->parent->left) {
       Node *w = x->parent->right;
       if (w->color == RED) { // caso 1
+        stats.recolor(2);
         w->color = BLACK;
         x->parent->color = RED;
         leftRotate(x->parent);
         w = x->parent->right;
       }
       if (w->left->color == BLACK && w->right->color == BLACK) { // caso 2
+        stats.recolor();
         w->color = RED;
         x = x->parent;
       } else {
         if (w->right->color == BLACK) { // caso 3
+          stats.recolor(2);
           w->left->color = BLACK;
           w->color = RED;
           rightRotate(w);
           w = x->parent->right;
         }
+        stats.recolor((w->color != x->parent->color) + (x->parent->color != BLACK) + 1);
         w->color = x->parent->color; // caso 4
         x->parent->color = BLACK;
         w->right->color = BLACK;
@@ -242,21 +487,25 @@ void RBNodeTree<T,B>::deleteFix(Node *x) {
     } else { // simétrico
       Node *w = x->parent->left;
       if (w->color == RED) {
+        stats.recolor(2);
         w->color = BLACK;
         x->parent->color = RED;
         rightRotate(x->parent);
         w = x->parent->left;
       }
       if (w->right->color == BLACK && w->left->color == BLACK) {
+        stats.recolor();
         w->color = RED;
         x = x->parent;
       } else {
         if (w->left->color == BLACK) {
+          stats.recolor(2);
           w->right->color = BLACK;
           w->color = RED;
           leftRotate(w);
           w = x->parent->left;
         }
+        stats.recolor((w->color != x->parent->color) + (x->parent->color != BLACK) + 1);
         w->color = x->parent->color;
         x->parent->color = BLACK;
         w->left->color = BLACK;
@@ -265,21 +514,464 @@ void RBNodeTree<T,B>::deleteFix(Node *x) {
       }
     }
   }
+  stats.recolor(x->color == RED);
   x->color = BLACK;
 }
 
-template <typename T, typename B>
-void RBNodeTree<T,B>::transplant(Node *u, Node *v) {
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::transplant(Node *u, Node *v) {
   if (u->parent == nil) root = v;
   else if (u == u->parent->left) u->parent->left = v;
   else u->parent->right = v;
   v->parent = u->parent;
 }
 
-template <typename T, typename B>
-typename RBNodeTree<T,B>::Node* RBNodeTree<T,B>::minimum(Node *x) const {
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::minimum(Node *x) const {
   while (x->left != nil) x = x->left;
   return x;
 }
 
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::maximum(Node *x) const {
+  while (x->right != nil) x = x->right;
+  return x;
+}
+
+// nil->parent lo ensucian transplant y deleteFix: la subida para al llegar a
+// nil, que es el padre de la raíz
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::successor(Node *x) const {
+  if (x->right != nil) return minimum(x->right);
+  Node *y = x->parent;
+  while (y != nil && x == y->right) {
+    x = y;
+    y = y->parent;
+  }
+  return y;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::predecessor(Node *x) const {
+  if (x->left != nil) return maximum(x->left);
+  Node *y = x->parent;
+  while (y != nil && x == y->left) {
+    x = y;
+    y = y->parent;
+  }
+  return y;
+}
+
+// range
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::iterator RBNodeTree<T,B,Stats,Augment>::lower_bound(const T &key) const {
+  Node *x = root, *best = nil;
+  while (x != nil) {
+    stats.visit();
+    stats.compare();
+    if (x->key < key) x = x->right;
+    else { best = x; x = x->left; }
+  }
+  return {best, this};
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::iterator RBNodeTree<T,B,Stats,Augment>::upper_bound(const T &key) const {
+  Node *x = root, *best = nil;
+  while (x != nil) {
+    stats.visit();
+    stats.compare();
+    if (key < x->key) { best = x; x = x->left; }
+    else x = x->right;
+  }
+  return {best, this};
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename F>
+void RBNodeTree<T,B,Stats,Augment>::for_each_in_range(const T &lo, const T &hi, F &&f) const {
+  rangeVisit(root, lo, hi, f);
+}
+
+// Baja hasta el primer nodo s dentro de [lo, hi]. Desde s->left se acumula,
+// por delante, cada nodo >= lo junto con su subárbol derecho entero; desde
+// s->right, por detrás, cada nodo <= hi con su subárbol izquierdo.
+template <typename T, typename B, typename Stats, typename Augment>
+typename Augment::value_type RBNodeTree<T,B,Stats,Augment>::aggregate(const T &lo, const T &hi) const requires Augment::enabled {
+  Node *s = root;
+  while (s != nil && (s->key < lo || hi < s->key))
+    s = (s->key < lo) ? s->right : s->left;
+  if (s == nil) return Augment::identity();
+
+  typename Augment::value_type before = Augment::identity(), after = Augment::identity();
+  for (Node *x = s->left; x != nil;) {
+    if (x->key < lo) { x = x->right; continue; }
+    before = Augment::combine(Augment::combine(Augment::lift(x->key, x->val), x->right->agg), before);
+    x = x->left;
+  }
+  for (Node *x = s->right; x != nil;) {
+    if (hi < x->key) { x = x->left; continue; }
+    after = Augment::combine(after, Augment::combine(x->left->agg, Augment::lift(x->key, x->val)));
+    x = x->right;
+  }
+  return Augment::combine(Augment::combine(before, Augment::lift(s->key, s->val)), after);
+}
+
+// interval
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename F>
+void RBNodeTree<T,B,Stats,Augment>::overlaps(const endpoint &a, const endpoint &b, F &&f) const requires Augment::interval {
+  overlapVisit(root, a, b, f);
+}
+
+// Se poda un subárbol cuando ningún fin llega a a (agg) y, al ir en orden de
+// inicio, se para en el primer nodo que empieza después de b. Cada nodo
+// visitado está en el camino a uno que se informa, o en los dos bordes:
+// O(log n + k log(n / k)), O(log n + k) si los k resultados quedan juntos.
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename F>
+void RBNodeTree<T,B,Stats,Augment>::overlapVisit(Node *x, const endpoint &a, const endpoint &b, F &f) const {
+  if (x == nil || x->agg < a) return;
+  overlapVisit(x->left, a, b, f);
+  if (b < x->key.first) return;
+  if (!(x->key.second < a)) f(x->key, x->val);
+  overlapVisit(x->right, a, b, f);
+}
+
+// inorden podado: sólo baja a los subárboles que pueden cortar [lo, hi]
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename F>
+void RBNodeTree<T,B,Stats,Augment>::rangeVisit(Node *x, const T &lo, const T &hi, F &f) const {
+  if (x == nil) return;
+  if (lo < x->key) rangeVisit(x->left, lo, hi, f);
+  if (!(x->key < lo) && !(hi < x->key)) f(x->key, x->val);
+  if (x->key < hi) rangeVisit(x->right, lo, hi, f);
+}
+
+// join
+// Basado en Blelloch, Ferizovic y Sun, "Just Join for Parallel Ordered Sets".
+// Los subárboles sueltos no mantienen el padre de su raíz ni se escribe nunca
+// en nil, así que varias tareas pueden trabajar a la vez sobre el mismo árbol.
+template <typename T, typename B, typename Stats, typename Augment>
+int RBNodeTree<T,B,Stats,Augment>::blackHeight(Node *x) const {
+  int h = 0;
+  for (; x != nil; x = x->left)
+    if (x->color == BLACK) h++;
+  return h;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::rotateLeftSub(Node *x) {
+  Node *y = x->right;
+  setRight(x, y->left);
+  y->left = x;
+  x->parent = y;
+  pull(x);
+  pull(y);
+  return y;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::rotateRightSub(Node *y) {
+  Node *x = y->left;
+  setLeft(y, x->right);
+  x->right = y;
+  y->parent = x;
+  pull(y);
+  pull(x);
+  return x;
+}
+
+// baja por el borde derecho de l hasta un nodo negro con la altura negra de r
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::joinRight(Node *l, int bhL, Node *m, Node *r, int bhR) {
+  if (l->color == BLACK && bhL == bhR) {
+    m->color = RED;
+    setLeft(m, l);
+    setRight(m, r);
+    pull(m);
+    return m;
+  }
+  Node *t = joinRight(l->right, bhL - (l->color == BLACK), m, r, bhR);
+  setRight(l, t);
+  pull(l);
+  if (l->color == BLACK && t->color == RED && t->right->color == RED) {
+    t->right->color = BLACK;
+    return rotateLeftSub(l);
+  }
+  return l;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::joinLeft(Node *l, int bhL, Node *m, Node *r, int bhR) {
+  if (r->color == BLACK && bhL == bhR) {
+    m->color = RED;
+    setLeft(m, l);
+    setRight(m, r);
+    pull(m);
+    return m;
+  }
+  Node *t = joinLeft(l, bhL, m, r->left, bhR - (r->color == BLACK));
+  setLeft(r, t);
+  pull(r);
+  if (r->color == BLACK && t->color == RED && t->left->color == RED) {
+    t->left->color = BLACK;
+    return rotateRightSub(r);
+  }
+  return r;
+}
+
+// l < m < r; las raíces de l y r se pintan de negro antes de empezar
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Sub RBNodeTree<T,B,Stats,Augment>::join(Sub l, Node *m, Sub r) {
+  if (l.root->color == RED) { l.root->color = BLACK; l.bh++; }
+  if (r.root->color == RED) { r.root->color = BLACK; r.bh++; }
+
+  Sub t;
+  if (l.bh > r.bh) {
+    t = Sub{joinRight(l.root, l.bh, m, r.root, r.bh), l.bh};
+    if (t.root->color == RED && t.root->right->color == RED) {
+      t.root->color = BLACK;
+      t.bh++;
+    }
+  } else if (r.bh > l.bh) {
+    t = Sub{joinLeft(l.root, l.bh, m, r.root, r.bh), r.bh};
+    if (t.root->color == RED && t.root->left->color == RED) {
+      t.root->color = BLACK;
+      t.bh++;
+    }
+  } else {
+    m->color = RED;
+    setLeft(m, l.root);
+    setRight(m, r.root);
+    pull(m);
+    t = Sub{m, l.bh};
+  }
+  t.root->parent = nil;
+  return t;
+}
+
+// l < r sin nodo intermedio: se saca el mínimo de r
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Sub RBNodeTree<T,B,Stats,Augment>::join2(Sub l, Sub r) {
+  if (r.root == nil) return l;
+  if (l.root == nil) return r;
+  Sub empty, rest;
+  Node *m = split(r, minimum(r.root)->key, empty, rest);
+  return join(l, m, rest);
+}
+
+// l < key < r; devuelve el nodo con la clave (suelto) o nullptr
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Node* RBNodeTree<T,B,Stats,Augment>::split(Sub t, const T &key, Sub &l, Sub &r) {
+  if (t.root == nil) {
+    l = r = Sub{nil, 0};
+    return nullptr;
+  }
+  Node *x = t.root;
+  if (key < x->key) {
+    Node *found = split(child(t, true), key, l, r);
+    r = join(r, x, child(t, false));
+    return found;
+  }
+  if (x->key < key) {
+    Node *found = split(child(t, false), key, l, r);
+    l = join(child(t, true), x, l);
+    return found;
+  }
+  l = child(t, true);
+  r = child(t, false);
+  return x;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename F, typename G>
+void RBNodeTree<T,B,Stats,Augment>::forkJoin(int depth, F &&f, G &&g) {
+  if (depth < setOp->forkDepth) setOp->pool.invoke(f, g);
+  else { f(); g(); }
+}
+
+// los nodos de a hacen de pivote; de b sólo se liberan los repetidos
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Sub RBNodeTree<T,B,Stats,Augment>::unionRB(Sub a, Sub b, int depth, size_t &repeated) {
+  if (a.root == nil) return b;
+  if (b.root == nil) return a;
+
+  Node *x = a.root;
+  Sub l2, r2;
+  Node *found = split(b, x->key, l2, r2);
+  if (found) {
+    x->val = found->val;
+    delete found;
+    repeated++;
+  }
+
+  Sub l, r;
+  size_t repeatedLeft = 0, repeatedRight = 0;
+  forkJoin(depth,
+           [&] { l = unionRB(child(a, true), l2, depth + 1, repeatedLeft); },
+           [&] { r = unionRB(child(a, false), r2, depth + 1, repeatedRight); });
+  repeated += repeatedLeft + repeatedRight;
+  return join(l, x, r);
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Sub RBNodeTree<T,B,Stats,Augment>::intersectRB(Sub a, Sub b, int depth, size_t &common) {
+  if (a.root == nil || b.root == nil) {
+    forkJoin(depth, [&] { destroyPar(a.root, depth + 1); }, [&] { destroyPar(b.root, depth + 1); });
+    return Sub{nil, 0};
+  }
+
+  Node *x = a.root;
+  Sub l2, r2;
+  Node *found = split(b, x->key, l2, r2);
+  Sub l, r;
+  size_t commonLeft = 0, commonRight = 0;
+  forkJoin(depth,
+           [&] { l = intersectRB(child(a, true), l2, depth + 1, commonLeft); },
+           [&] { r = intersectRB(child(a, false), r2, depth + 1, commonRight); });
+  common += commonLeft + commonRight;
+
+  if (found) {
+    delete found;
+    common++;
+    return join(l, x, r);
+  }
+  delete x;
+  return join2(l, r);
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+typename RBNodeTree<T,B,Stats,Augment>::Sub RBNodeTree<T,B,Stats,Augment>::differenceRB(Sub a, Sub b, int depth, size_t &removed) {
+  if (a.root == nil) {
+    destroyPar(b.root, depth);
+    return a;
+  }
+  if (b.root == nil) return a;
+
+  Node *y = b.root;
+  Sub bl = child(b, true), br = child(b, false);
+  Sub l1, r1;
+  Node *found = split(a, y->key, l1, r1);
+  delete y;
+  if (found) {
+    delete found;
+    removed++;
+  }
+
+  Sub l, r;
+  size_t removedLeft = 0, removedRight = 0;
+  forkJoin(depth,
+           [&] { l = differenceRB(l1, bl, depth + 1, removedLeft); },
+           [&] { r = differenceRB(r1, br, depth + 1, removedRight); });
+  removed += removedLeft + removedRight;
+  return join2(l, r);
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::destroyPar(Node *x, int depth) {
+  if (x == nil) return;
+  Node *l = x->left, *r = x->right;
+  delete x;
+  forkJoin(depth, [&] { destroyPar(l, depth + 1); }, [&] { destroyPar(r, depth + 1); });
+}
+
+// cambia los enlaces a oldNil por el nil de este árbol
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::relink(Node *x, Node *oldNil, int depth) {
+  if (x->left == oldNil) x->left = nil;
+  if (x->right == oldNil) x->right = nil;
+  if (x->parent == oldNil) x->parent = nil;
+  forkJoin(depth,
+           [&] { if (x->left != nil) relink(x->left, oldNil, depth + 1); },
+           [&] { if (x->right != nil) relink(x->right, oldNil, depth + 1); });
+}
+
+// Los dos árboles tienen que compartir centinela: se reenlaza el más pequeño,
+// O(m), y si es este se intercambian los nil para quedarse con el de other.
+template <typename T, typename B, typename Stats, typename Augment>
+template <typename Op>
+void RBNodeTree<T,B,Stats,Augment>::runSetOp(RBNodeTree &other, workStealingPool &pool, Op op) {
+  setOpContext ctx{pool, 0};
+  if (pool.size() > 1) {
+    while ((1u << ctx.forkDepth) < pool.size()) ctx.forkDepth++;
+    ctx.forkDepth += 4;
+  }
+  setOp = &ctx;
+
+  Node *a = root, *b = other.root;
+  bool relinkThis = sz < other.sz;
+  if (relinkThis) std::swap(nil, other.nil);
+  other.root = other.nil;
+  other.sz = 0;
+
+  pool.run([&] {
+    if (relinkThis && a != other.nil) relink(a, other.nil, 0);
+    if (!relinkThis && b != other.nil) relink(b, other.nil, 0);
+    if (a == other.nil) a = nil;
+    if (b == other.nil) b = nil;
+    Sub t = op(Sub{a, blackHeight(a)}, Sub{b, blackHeight(b)});
+    root = t.root;
+  });
+  setOp = nullptr;
+
+  root->parent = nil;
+  root->color = BLACK;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::union_with(RBNodeTree &other, workStealingPool &pool) {
+  if (&other == this) return;
+  size_t n = sz + other.sz, repeated = 0;
+  runSetOp(other, pool, [&](Sub a, Sub b) { return unionRB(a, b, 0, repeated); });
+  sz = n - repeated;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::intersect_with(RBNodeTree &other, workStealingPool &pool) {
+  if (&other == this) return;
+  size_t common = 0;
+  runSetOp(other, pool, [&](Sub a, Sub b) { return intersectRB(a, b, 0, common); });
+  sz = common;
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::difference_with(RBNodeTree &other, workStealingPool &pool) {
+  if (&other == this) {
+    destroy(root);
+    root = nil;
+    sz = 0;
+    return;
+  }
+  size_t n = sz, removed = 0;
+  runSetOp(other, pool, [&](Sub a, Sub b) { return differenceRB(a, b, 0, removed); });
+  sz = n - removed;
+}
+
+// snapshot
+template <typename T, typename B, typename Stats, typename Augment>
+frozenTree<T,B> RBNodeTree<T,B,Stats,Augment>::freeze() const {
+  std::vector<T> keys;
+  std::vector<B> vals;
+  keys.reserve(sz);
+  vals.reserve(sz);
+  collectInorder(root, keys, vals);
+  return frozenTree<T,B>(keys, vals);
+}
+
+template <typename T, typename B, typename Stats, typename Augment>
+void RBNodeTree<T,B,Stats,Augment>::collectInorder(Node *x, std::vector<T> &keys, std::vector<B> &vals) const {
+  if (x == nil) return;
+  collectInorder(x->left, keys, vals);
+  keys.push_back(x->key);
+  vals.push_back(x->val);
+  collectInorder(x->right, keys, vals);
+}
+
+// Árbol de intervalos cerrados [inicio, fin] con un valor cada uno. Un mismo
+// intervalo insertado dos veces se queda con el último valor, como cualquier
+// clave repetida.
+template <typename T, typename B, typename Stats = noStats>
+using RBIntervalTree = RBNodeTree<std::pair<T, T>, B, Stats, intervalAugment<T>>;
+
 #endif /* RB_NODE_TREE_H */
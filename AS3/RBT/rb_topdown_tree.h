@@ -0,0 +1,222 @@
+#ifndef RB_TOPDOWN_TREE_H
+#define RB_TOPDOWN_TREE_H
+
+#include <cstddef>
+#include "../common/memoryUsage.h"
+
+// Variante de RBLeafTree sin puntero al padre: insert y erase reequilibran en
+// una sola pasada de la raíz a la hoja (Guibas y Sedgewick), así que no hay
+// que recordar ancestros y cada operación sólo reserva los nodos que añade.
+// Mismas reglas que RBLeafTree: las hojas guardan los pares y son siempre
+// negras; los internos llevan la clave mínima de su subárbol derecho.
+template <typename T, typename B>
+class RBTopDownTree {
+  enum Color { RED, BLACK };
+
+  struct Node {
+    T key;
+    B val;
+    Node *link[2]; // 0 izquierda, 1 derecha
+    bool leaf;
+    Color color;
+
+    Node(const T& k,
+         const B& v,
+         Node* l = nullptr,
+         Node* r = nullptr,
+         bool lf = true,
+         Color c = BLACK)
+      : key{k}, val{v}, link{l, r}, leaf{lf}, color{c} {}
+  };
+
+  Node *root {nullptr};
+  size_t sz {0};
+
+ public:
+  RBTopDownTree() = default;
+  ~RBTopDownTree() { destroy(root); }
+  RBTopDownTree(const RBTopDownTree&) = delete;
+  RBTopDownTree& operator=(const RBTopDownTree&) = delete;
+
+  void insert(const T& key, const B& val);
+  bool erase(const T& key);
+  const B* find(const T& key) const;
+  size_t size() const { return sz; }
+
+  // nodos con new/delete: sz hojas y sz - 1 internos
+  memoryUsage memory_usage() const {
+    memoryUsage m;
+    m.leafNodes = sz;
+    m.internalNodes = sz > 0 ? sz - 1 : 0;
+    size_t nodes = m.leafNodes + m.internalNodes;
+    m.nodeBytes = nodes * sizeof(Node);
+    m.overheadBytes = nodes * (heapBlockBytes(sizeof(Node)) - sizeof(Node)) + sizeof(*this);
+    return m;
+  }
+
+ private:
+  void destroy(Node* x);
+
+  static bool isRed(const Node* x) { return x && x->color == RED; }
+  // hijo de x por el que sigue key: 0 si key < x->key
+  static int dirOf(const Node* x, const T& key) { return !(key < x->key); }
+
+  // rotación hacia dir: sube el hijo !dir, que queda negro, y x queda rojo
+  static Node* rotate(Node* x, int dir);
+  static Node* rotateTwice(Node* x, int dir);
+};
+
+// imp
+template <typename T, typename B>
+void RBTopDownTree<T,B>::destroy(Node* x) {
+  if (!x) return;
+  destroy(x->link[0]);
+  destroy(x->link[1]);
+  delete x;
+}
+
+template <typename T, typename B>
+const B* RBTopDownTree<T,B>::find(const T& key) const {
+  Node* x = root;
+  while (x && !x->leaf)
+    x = x->link[dirOf(x, key)];
+  return (x && x->key == key) ? &x->val : nullptr;
+}
+
+// rot
+template <typename T, typename B>
+typename RBTopDownTree<T,B>::Node* RBTopDownTree<T,B>::rotate(Node* x, int dir) {
+  Node* y = x->link[!dir];
+  x->link[!dir] = y->link[dir];
+  y->link[dir] = x;
+  x->color = RED;
+  y->color = BLACK;
+  return y;
+}
+
+template <typename T, typename B>
+typename RBTopDownTree<T,B>::Node* RBTopDownTree<T,B>::rotateTwice(Node* x, int dir) {
+  x->link[!dir] = rotate(x->link[!dir], !dir);
+  return rotate(x, dir);
+}
+
+// insert
+// Al bajar, todo nodo con dos hijos rojos se vuelve rojo y los hijos negros;
+// si eso deja dos rojos seguidos se rota en el abuelo. La hoja alcanzada se
+// sustituye por un interno rojo con las dos hojas, y se corrige igual.
+// Tras una rotación gSlot y pSlot quedan desfasados un par de niveles, pero
+// en ellos no puede aparecer otra violación (q y sus hijos acaban de pasar a
+// negro) y para entonces ya vuelven a apuntar a g y p.
+template <typename T, typename B>
+void RBTopDownTree<T,B>::insert(const T& key, const B& val) {
+  if (!root) {
+    root = new Node(key, val);
+    ++sz;
+    return;
+  }
+
+  Node **gSlot = nullptr, **pSlot = nullptr, **qSlot = &root;
+  Node *g = nullptr, *p = nullptr, *q = root;
+  int dir = 0, last = 0;
+  for (;;) {
+    bool atLeaf = q->leaf;
+    // el hijo en dir se va a visitar de todos modos: mirarlo primero evita
+    // cargar el otro casi siempre
+    int next = atLeaf ? 0 : dirOf(q, key);
+    if (atLeaf) {
+      // clave ya existente -> actualizar valor
+      if (q->key == key) {
+        q->val = val;
+        break;
+      }
+      Node* leaf = new Node(key, val);
+      q = *qSlot = (key < q->key) ? new Node(q->key, B(), leaf, q, false, RED)
+                                  : new Node(key, B(), q, leaf, false, RED);
+      ++sz;
+    } else if (isRed(q->link[next]) && isRed(q->link[!next])) {
+      // cambio de color
+      q->color = RED;
+      q->link[0]->color = BLACK;
+      q->link[1]->color = BLACK;
+    }
+
+    // dos rojos seguidos: p es rojo, luego no es la raíz y g existe
+    if (isRed(q) && isRed(p))
+      *gSlot = (q == p->link[last]) ? rotate(g, !last) : rotateTwice(g, !last);
+
+    if (atLeaf) break;
+    last = dir;
+    dir = next;
+    gSlot = pSlot; pSlot = qSlot; qSlot = &q->link[dir];
+    g = p; p = q; q = *qSlot;
+  }
+  root->color = BLACK;
+}
+
+// erase
+// Al bajar se empuja un rojo por el camino: al salir de cada nodo interno q,
+// éste o su hijo en la dirección de key es rojo. Al llegar a la hoja, su
+// padre q es rojo (o la raíz) y se puede quitar con ella sin tocar la altura
+// negra: el hermano ocupa su lugar.
+template <typename T, typename B>
+bool RBTopDownTree<T,B>::erase(const T& key) {
+  if (!root) return false;
+  if (root->leaf) {
+    if (root->key != key) return false;
+    delete root;
+    root = nullptr;
+    sz = 0;
+    return true;
+  }
+
+  Node **pSlot = nullptr, **qSlot = &root;
+  Node *p = nullptr, *q = root;
+  int last = 0;
+  bool found = false;
+  for (;;) {
+    int dir = dirOf(q, key);
+
+    if (!isRed(q) && !isRed(q->link[dir])) {
+      if (isRed(q->link[!dir])) {
+        // el otro hijo es rojo: rotar para que q baje y quede rojo
+        Node* top = *qSlot = rotate(q, dir);
+        qSlot = &top->link[dir];
+      } else if (p) {
+        // p es rojo y el hermano s es interno (misma altura negra que q)
+        Node* s = p->link[!last];
+        if (!isRed(s->link[0]) && !isRed(s->link[1])) {
+          // cambio de color
+          p->color = BLACK;
+          s->color = RED;
+          q->color = RED;
+        } else {
+          Node* top = isRed(s->link[last]) ? rotateTwice(p, last) : rotate(p, last);
+          *pSlot = top;
+          top->color = RED;
+          q->color = RED;
+          top->link[0]->color = BLACK;
+          top->link[1]->color = BLACK;
+        }
+      }
+    }
+
+    Node* next = q->link[dir];
+    if (next->leaf) {
+      if (next->key == key) {
+        *qSlot = q->link[!dir];
+        delete next;
+        delete q;
+        --sz;
+        found = true;
+      }
+      break;
+    }
+    pSlot = qSlot; qSlot = &q->link[dir];
+    p = q; q = next;
+    last = dir;
+  }
+  if (root) root->color = BLACK;
+  return found;
+}
+
+#endif /* RB_TOPDOWN_TREE_H */
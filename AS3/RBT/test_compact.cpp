@@ -0,0 +1,52 @@
+#include <cassert>
+#include <iostream>
+#include <map>
+#include "rb_compact_tree.h"
+int main() {
+  RBCompactTree<int,int> tree;
+
+  tree.insert(10, 100);
+  tree.insert(5, 50);
+  tree.insert(20, 200);
+  assert(tree.size() == 3);
+  assert(tree.find(10) && tree.find(10)->val == 100);
+  assert(!tree.find(99));
+
+  tree.insert(10, 101); // sobrescribe
+  assert(tree.size() == 3 && tree.find(10)->val == 101);
+
+  assert(tree.erase(5));
+  assert(!tree.erase(5));
+  assert(tree.size() == 2 && !tree.find(5));
+
+  // inserciones y borrados mezclados frente a std::map
+  RBCompactTree<int,int> mixed;
+  std::map<int,int> ref;
+  unsigned x = 777;
+  for (int i = 0; i < 20000; i++) {
+    x = x * 1103515245 + 12345;
+    int k = int(x >> 8) % 2000;
+    if (x & 0x100000) {
+      mixed.insert(k, i);
+      ref[k] = i;
+    } else {
+      assert(mixed.erase(k) == (ref.erase(k) == 1));
+    }
+  }
+  assert(mixed.size() == ref.size());
+  for (int k = 0; k < 2000; k++) {
+    auto n = mixed.find(k);
+    auto it = ref.find(k);
+    assert((n != nullptr) == (it != ref.end()));
+    if (n) assert(n->val == it->second);
+  }
+
+  // los huecos de erase se reutilizan: vaciar y rellenar no hace crecer el vector
+  size_t bytes = mixed.capacityBytes();
+  for (auto [k, v] : ref) mixed.erase(k);
+  assert(mixed.size() == 0);
+  for (auto [k, v] : ref) mixed.insert(k, v);
+  assert(mixed.size() == ref.size() && mixed.capacityBytes() == bytes);
+
+  std::cout << "Pruebas básicas superadas.\n";
+}
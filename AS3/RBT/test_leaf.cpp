@@ -1,6 +1,8 @@
 #include <cassert>
 #include <iostream>
+#include <set>
 #include "rb_leaf_tree.h"
+#include "rb_topdown_tree.h"
 int main() {
   RBLeafTree<int,std::string> tree;
 
@@ -26,6 +28,72 @@ int main() {
 
   for (int k : {10, 15, 7, 30}) assert(tree.find(k));
 
+  // recorrido por las hojas enlazadas: 7 10 15 30
+  auto it = tree.lower_bound(8);
+  assert(it != tree.end() && it.key() == 10);
+  assert((++it).key() == 15);
+  assert(tree.upper_bound(15).key() == 30);
+  assert(tree.lower_bound(31) == tree.end());
+  assert((--tree.end()).key() == 30);
+  int prev = 0, n = 0;
+  for (auto [k, v] : tree) { assert(k > prev); prev = k; n++; }
+  assert(n == 4);
+
+  // inserciones y borrados mezclados frente a std::set: con el insertFix
+  // que tomaba al padre por abuelo, las hojas rojas y el deleteFix tras
+  // quitar un interno rojo se perdían claves
+  RBLeafTree<int,int> mixed;
+  std::set<int> ref;
+  unsigned x = 12345;
+  for (int i = 0; i < 20000; i++) {
+    x = x * 1103515245 + 12345;
+    int k = int(x >> 8) % 2000;
+    if (x & 0x100000) {
+      mixed.insert(k, k);
+      ref.insert(k);
+    } else {
+      assert(mixed.erase(k) == (ref.erase(k) == 1));
+    }
+  }
+  assert(mixed.size() == ref.size());
+  for (int k = 0; k < 2000; k++) assert((mixed.find(k) != nullptr) == (ref.count(k) == 1));
+
+  // lo mismo con RBTopDownTree, comprobando también el valor guardado
+  RBTopDownTree<int,int> topDown;
+  ref.clear();
+  for (int i = 0; i < 20000; i++) {
+    x = x * 1103515245 + 12345;
+    int k = int(x >> 8) % 2000;
+    if (x & 0x100000) {
+      topDown.insert(k, k + 1);
+      ref.insert(k);
+    } else {
+      assert(topDown.erase(k) == (ref.erase(k) == 1));
+    }
+    assert(topDown.size() == ref.size());
+  }
+  for (int k = 0; k < 2000; k++) {
+    const int *v = topDown.find(k);
+    assert((v != nullptr) == (ref.count(k) == 1));
+    if (v) assert(*v == k + 1);
+  }
+
+  // estadísticas: con 1, 2, 3 en orden la hoja de 3 queda a profundidad 2
+  RBLeafTree<int,int,countingStats> counted;
+  for (int k : {1, 2, 3}) counted.insert(k, k);
+  statsSnapshot s = counted.getStats();
+  assert(s.rotations == 0 && s.fixups == 0);
+  counted.resetStats();
+  counted.find(1);
+  counted.find(3);
+  s = counted.getStats();
+  assert(s.searches == 2 && s.visits == 5);
+  assert(s.depthHistogram[2] == 1 && s.depthHistogram[3] == 1);
+
+  memoryUsage m = counted.memory_usage();
+  assert(m.leafNodes == 3 && m.internalNodes == 2);
+  assert(m.totalBytes() > m.nodeBytes);
+
   std::cout << "Pruebas básicas superadas.\n";
 }
 
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <iostream>
+#include <map>
 #include "rb_node_tree.h"
 int main() {
   RBNodeTree<int,std::string> tree;
@@ -27,6 +28,107 @@ int main() {
 
   for (int k : {10, 15, 7, 30}) assert(tree.find(k));
 
+  // recorrido inorden y rangos: 7 10 15 30
+  auto it = tree.lower_bound(8);
+  assert(it != tree.end() && it.key() == 10);
+  assert((++it).key() == 15);
+  assert((--it).key() == 10);
+  assert(tree.upper_bound(15).key() == 30);
+  assert(tree.lower_bound(31) == tree.end());
+  assert((--tree.end()).key() == 30);
+  auto [lo, hi] = tree.equal_range(15);
+  assert(lo.key() == 15 && hi.key() == 30);
+  int prev = 0, n = 0;
+  for (auto [k, v] : tree) { assert(k > prev); prev = k; n++; }
+  assert(n == 4);
+  int sum = 0;
+  tree.for_each_in_range(7, 15, [&](int k, const std::string &) { sum += k; });
+  assert(sum == 7 + 10 + 15);
+
+  // agregados por rango: suma y máximo de los valores de [lo, hi]
+  RBNodeTree<int,int,noStats,sumAugment<int>> sums;
+  RBNodeTree<int,int,noStats,maxAugment<int>> maxes;
+  for (int k = 1; k <= 10; k++) { sums.insert(k, k * 10); maxes.insert(k, k % 4); }
+  assert(sums.aggregate(3, 5) == 120);
+  assert(sums.aggregate(0, 100) == 550);
+  assert(sums.aggregate(11, 20) == 0);
+  sums.erase(4);
+  sums.insert(5, 1);
+  assert(sums.aggregate(3, 5) == 31);
+  assert(maxes.aggregate(4, 6) == 2 && maxes.aggregate(1, 10) == 3);
+
+  // intervalos: [1,5] [3,4] [6,9] [8,20]
+  RBIntervalTree<int,char> spans;
+  spans.insert({1, 5}, 'a');
+  spans.insert({3, 4}, 'b');
+  spans.insert({6, 9}, 'c');
+  spans.insert({8, 20}, 'd');
+  std::string hit;
+  spans.overlaps(4, 7, [&](const std::pair<int,int> &, char v) { hit += v; });
+  assert(hit == "abc");
+  hit.clear();
+  spans.stab(10, [&](const std::pair<int,int> &, char v) { hit += v; });
+  assert(hit == "d");
+  spans.erase({8, 20});
+  hit.clear();
+  spans.stab(10, [&](const std::pair<int,int> &, char v) { hit += v; });
+  assert(hit.empty());
+
+  // estadísticas: 1, 2, 3 en orden fuerzan una rotación en el abuelo
+  RBNodeTree<int,int,countingStats> counted;
+  for (int k : {1, 2, 3}) counted.insert(k, k);
+  statsSnapshot s = counted.getStats();
+  assert(s.rotations == 1 && s.fixups == 1);
+  assert(s.recolors == 3);              // raíz inicial y caso 3
+  counted.resetStats();
+  counted.find(2);
+  counted.find(3);
+  counted.find(4);
+  s = counted.getStats();
+  assert(s.searches == 3 && s.visits == 5);
+  assert(s.depthHistogram.size() == 3 && s.depthHistogram[1] == 1 && s.depthHistogram[2] == 2);
+
+  memoryUsage m = counted.memory_usage();
+  assert(m.leafNodes == 3 && m.internalNodes == 0);
+  assert(m.totalBytes() >= 4 * m.nodeBytes / 3); // nodos más el centinela
+
+  // conjuntos frente a std::map; other queda vacío y en la unión gana su valor
+  RBNodeTree<int,int> set;
+  std::map<int,int> ref;
+  unsigned x = 99;
+  auto next = [&](int range) { x = x * 1103515245 + 12345; return int(x >> 8) % range; };
+  for (int i = 0; i < 300; i++) { int k = next(500); set.insert(k, i); ref[k] = i; }
+  for (int i = 0; i < 30; i++) {
+    RBNodeTree<int,int> other;
+    std::map<int,int> refO;
+    for (int j = next(400); j > 0; j--) { int k = next(500); other.insert(k, 1000 + j); refO[k] = 1000 + j; }
+    if (i % 3 == 0) {
+      set.union_with(other);
+      for (auto [k, v] : refO) ref[k] = v;
+    } else if (i % 3 == 1) {
+      set.intersect_with(other);
+      std::erase_if(ref, [&](auto &p) { return !refO.contains(p.first); });
+    } else {
+      set.difference_with(other);
+      std::erase_if(ref, [&](auto &p) { return refO.contains(p.first); });
+    }
+    assert(other.size() == 0 && other.begin() == other.end());
+    assert(set.size() == ref.size());
+    auto r = ref.begin();
+    for (auto [k, v] : set) { assert(r != ref.end() && k == r->first && v == r->second); ++r; }
+    assert(r == ref.end());
+    if (ref.size() < 100)
+      for (int j = 0; j < 300; j++) { int k = next(500); set.insert(k, j); ref[k] = j; }
+  }
+  // consigo mismo: unión e intersección no cambian nada, la diferencia vacía
+  set.union_with(set);
+  set.intersect_with(set);
+  assert(set.size() == ref.size());
+  set.difference_with(set);
+  assert(set.size() == 0 && set.begin() == set.end());
+  set.insert(1, 1);
+  assert(set.size() == 1 && set.find(1));
+
   std::cout << "Pruebas básicas superadas.\n";
 }
 
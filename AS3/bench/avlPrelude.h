@@ -0,0 +1,21 @@
+#ifndef AVLPRELUDE_H
+#define AVLPRELUDE_H
+
+// Dependencias de AVL/avl.h, incluidas fuera de cualquier espacio de nombres.
+// benchAVL.cpp incluye avl.h dentro de uno propio para que sus
+// nodeTree/leafTree no choquen con los de NodeTree/; las guardas de estas
+// cabeceras evitan que se vuelvan a abrir dentro.
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../common/frozenTree.h"
+#include "../common/nodePool.h"
+#include "../common/subtreeCount.h"
+#include "../common/workStealingPool.h"
+
+#endif
@@ -0,0 +1,19 @@
+#include "treeBench.h"
+#include "avlPrelude.h"
+
+namespace avl {
+#include "../AVL/avl.h"
+}
+
+// Los dos backends de AVLTree en la misma unidad de traducción
+void benchAVL(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out)
+{
+  benchTree<avl::AVLTree<int, int, avl::nodeBackend>>("avlNodeTree", in, cfg, out);
+  benchTree<avl::AVLTree<int, int, avl::leafBackend>>("avlLeafTree", in, cfg, out);
+}
+
+void memoryAVL(const std::vector<int>& keys, std::vector<memoryRecord>& out)
+{
+  memoryTree<avl::AVLTree<int, int, avl::nodeBackend>>("avlNodeTree", keys, out);
+  memoryTree<avl::AVLTree<int, int, avl::leafBackend>>("avlLeafTree", keys, out);
+}
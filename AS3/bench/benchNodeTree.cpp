@@ -0,0 +1,23 @@
+#include "treeBench.h"
+#include "../NodeTree/nodeTree.h"
+#include "../NodeTree/leafTree.h"
+#include "../NodeTree/bPlusTree.h"
+
+// nodeTree y leafTree no se equilibran: con entradas ordenadas su altura es
+// n y la inserción recursiva agotaría la pila, así que se omiten
+void benchNodeTrees(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out)
+{
+  if (!in.degenerate) {
+    benchTree<nodeTree<int, int>>("nodeTree", in, cfg, out);
+    benchTree<leafTree<int, int>>("leafTree", in, cfg, out);
+  }
+  benchTree<bPlusTree<int, int>>("bPlusTree", in, cfg, out);
+}
+
+// Las claves de memoryTree son siempre uniformes
+void memoryNodeTrees(const std::vector<int>& keys, std::vector<memoryRecord>& out)
+{
+  memoryTree<nodeTree<int, int>>("nodeTree", keys, out);
+  memoryTree<leafTree<int, int>>("leafTree", keys, out);
+  memoryTree<bPlusTree<int, int>>("bPlusTree", keys, out);
+}
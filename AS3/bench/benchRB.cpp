@@ -0,0 +1,29 @@
+#include "treeBench.h"
+#include "../RBT/rb_node_tree.h"
+#include "../RBT/rb_leaf_tree.h"
+
+template<>
+struct treeAdapter<RBNodeTree<int, int>> {
+  static void insert(RBNodeTree<int, int>& t, int k, int v) { t.insert(k, v); }
+  static bool find(RBNodeTree<int, int>& t, int k) { return t.find(k) != nullptr; }
+  static void erase(RBNodeTree<int, int>& t, int k) { t.erase(k); }
+};
+
+template<>
+struct treeAdapter<RBLeafTree<int, int>> {
+  static void insert(RBLeafTree<int, int>& t, int k, int v) { t.insert(k, v); }
+  static bool find(RBLeafTree<int, int>& t, int k) { return t.find(k) != nullptr; }
+  static void erase(RBLeafTree<int, int>& t, int k) { t.erase(k); }
+};
+
+void benchRBTrees(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out)
+{
+  benchTree<RBNodeTree<int, int>>("rbNodeTree", in, cfg, out);
+  benchTree<RBLeafTree<int, int>>("rbLeafTree", in, cfg, out);
+}
+
+void memoryRBTrees(const std::vector<int>& keys, std::vector<memoryRecord>& out)
+{
+  memoryTree<RBNodeTree<int, int>>("rbNodeTree", keys, out);
+  memoryTree<RBLeafTree<int, int>>("rbLeafTree", keys, out);
+}
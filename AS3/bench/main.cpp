@@ -0,0 +1,202 @@
+// Benchmark unificado: nodeTree, leafTree y bPlusTree (NodeTree/), AVLTree
+// con sus dos backends (AVL/), RBNodeTree y RBLeafTree (RBT/) y std::map,
+// con las mismas claves y un único esquema CSV (ver writeCsv en
+// common/benchHarness.h).
+//   g++ -O2 -std=c++20 -pthread main.cpp benchNodeTree.cpp benchAVL.cpp benchRB.cpp -o treeBench
+// (plots.py dibuja tree_results.csv)
+//
+// Uso: ./treeBench [opciones] [n_max]   (por defecto 100000)
+// Tamaños 1e3, 5e3, 1e4, 5e4... hasta n_max.
+// Opciones: --trials N, --warmup N, --ops-per-sample N, --cpu K (-1: sin fijar),
+//           --order uniform|sequential|reverse|clustered|adversarial|zipfian
+//           (orden de inserción; zipfian inserta uniforme y sesga las búsquedas),
+//           --seed S, --counters (contadores hardware por operación; ver
+//           common/perfCounters.h), --no-latency (sin las pasadas que
+//           cronometran cada operación para p50/p90/p99/p99.9/max)
+//           --memory: en lugar de tiempos, memoria de cada árbol construido con
+//           n = 1e3, 1e4... n_max claves uniformes: memory_usage(), heap de
+//           malloc y pico de RSS, en memory_results.csv
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "treeBench.h"
+
+using namespace std;
+
+static void benchStdMap(const benchInputs& in, const benchConfig& cfg, vector<benchRecord>& out)
+{
+  benchTree<map<int, int>>("std::map", in, cfg, out);
+}
+
+static benchInputs makeInputs(const workload& wl, size_t n, keyOrder order)
+{
+  benchInputs in;
+  bool skewedFinds = order == keyOrder::zipfian;
+  in.keys = wl.keys(n, skewedFinds ? keyOrder::uniform : order);
+  in.hits = skewedFinds ? wl.keys(n, keyOrder::zipfian, 2) : wl.keys(n, keyOrder::uniform, 2);
+  in.misses = wl.missing(n);
+  in.deletes = wl.keys(n, keyOrder::uniform, 1);
+  in.degenerate = n > 20000 && (order == keyOrder::sequential || order == keyOrder::reverse ||
+                                order == keyOrder::adversarial);
+  return in;
+}
+
+// Medias en ns por operación de las filas de tamaño n, la cola de latencia
+// y, si se pidieron, los contadores hardware por operación
+static void printTable(const vector<benchRecord>& records, size_t n, const benchConfig& cfg)
+{
+  const char* ops[] = {"insert", "find_hit", "find_miss", "delete"};
+  vector<string> trees;
+  for (const benchRecord& r : records)
+    if (r.n == n && find(trees.begin(), trees.end(), r.tree) == trees.end()) trees.push_back(r.tree);
+
+  cout << setw(14) << "tree";
+  for (const char* op : ops) cout << setw(12) << op;
+  cout << "   (mean ns/op)" << endl;
+  for (const string& tree : trees) {
+    cout << setw(14) << tree;
+    for (const char* op : ops) {
+      double mean = NAN;
+      for (const benchRecord& r : records)
+        if (r.n == n && r.tree == tree && r.op == op) mean = r.stats.mean;
+      cout << setw(12) << fixed << setprecision(1) << mean;
+    }
+    cout << endl;
+  }
+
+  if (cfg.latency) {
+    cout << setw(14) << "tree" << setw(12) << "op" << setw(10) << "p50" << setw(10) << "p90"
+         << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "max" << "   (ns, single ops)" << endl;
+    for (const benchRecord& r : records) {
+      if (r.n != n) continue;
+      const latencyPercentiles& l = r.stats.latency;
+      cout << setw(14) << r.tree << setw(12) << r.op << fixed << setprecision(0)
+           << setw(10) << l.p50 << setw(10) << l.p90 << setw(10) << l.p99
+           << setw(10) << l.p999 << setw(10) << l.max << endl;
+    }
+  }
+  if (!cfg.counters) return;
+
+  cout << setw(14) << "tree" << setw(12) << "op" << setw(10) << "instr" << setw(10) << "IPC"
+       << setw(10) << "L1D miss" << setw(10) << "LLC miss" << setw(10) << "dTLB miss"
+       << setw(10) << "br miss" << "   (per op)" << endl;
+  for (const benchRecord& r : records) {
+    if (r.n != n) continue;
+    const perfCounts& c = r.stats.counters;
+    cout << setw(14) << r.tree << setw(12) << r.op << fixed << setprecision(1)
+         << setw(10) << c.instructions << setw(10) << setprecision(2) << c.instructions / c.cycles
+         << setw(10) << c.l1dMisses << setw(10) << c.llcMisses << setw(10) << c.dtlbMisses
+         << setw(10) << c.branchMisses << endl;
+  }
+}
+
+static void writeMemoryCsv(ostream& out, const vector<memoryRecord>& records)
+{
+  out << "tree,n,node_bytes,overhead_bytes,internal_nodes,leaf_nodes,heap_bytes,rss_before,peak_rss\n";
+  for (const memoryRecord& r : records) {
+    out << r.tree << ',' << r.n << ',' << r.usage.nodeBytes << ',' << r.usage.overheadBytes << ','
+        << r.usage.internalNodes << ',' << r.usage.leafNodes << ',' << r.heapBytes << ','
+        << r.rssBefore << ',' << r.peakRss << '\n';
+  }
+}
+
+// Bytes por clave: según memory_usage() (nodos y total), según el heap de
+// malloc y según el crecimiento del pico de RSS
+static void printMemoryTable(const vector<memoryRecord>& records, size_t n)
+{
+  cout << setw(14) << "tree" << setw(10) << "nodes" << setw(10) << "total" << setw(10) << "heap"
+       << setw(10) << "peak RSS" << setw(12) << "internal" << setw(12) << "leaf"
+       << "   (bytes/key)" << endl;
+  for (const memoryRecord& r : records) {
+    if (r.n != n) continue;
+    bool model = r.usage.totalBytes() > 0;
+    cout << setw(14) << r.tree << fixed << setprecision(1)
+         << setw(10) << (model ? double(r.usage.nodeBytes) / n : NAN)
+         << setw(10) << (model ? double(r.usage.totalBytes()) / n : NAN)
+         << setw(10) << double(r.heapBytes) / n
+         << setw(10) << (double(r.peakRss) - double(r.rssBefore)) / n
+         << setw(12) << r.usage.internalNodes << setw(12) << r.usage.leafNodes << endl;
+  }
+}
+
+static void runMemory(const workload& wl, size_t maxN)
+{
+  vector<memoryRecord> records;
+  for (size_t n = 1000; n <= maxN; n *= 10) {
+    cout << "\nn = " << n << endl;
+    vector<int> keys = wl.keys(n, keyOrder::uniform);
+    memoryNodeTrees(keys, records);
+    memoryAVL(keys, records);
+    memoryRBTrees(keys, records);
+    memoryTree<map<int, int>>("std::map", keys, records);
+    printMemoryTable(records, n);
+  }
+  ofstream csv("memory_results.csv");
+  writeMemoryCsv(csv, records);
+  cout << "\nResults saved to 'memory_results.csv'" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+  benchConfig config;
+  workload wl;
+  keyOrder order = keyOrder::uniform;
+  size_t maxN = 100000;
+  bool memory = false;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--trials" && hasValue) config.trials = stoi(argv[++i]);
+    else if (arg == "--warmup" && hasValue) config.warmup = stoi(argv[++i]);
+    else if (arg == "--ops-per-sample" && hasValue) config.batch = stoul(argv[++i]);
+    else if (arg == "--cpu" && hasValue) config.cpu = stoi(argv[++i]);
+    else if (arg == "--order" && hasValue) order = workload::parseOrder(argv[++i]);
+    else if (arg == "--seed" && hasValue) wl = workload(stoull(argv[++i]));
+    else if (arg == "--counters") config.counters = true;
+    else if (arg == "--memory") memory = true;
+    else if (arg == "--no-latency") config.latency = false;
+    else maxN = size_t(stod(arg));
+  }
+  if (memory) {
+    runMemory(wl, maxN);
+    return 0;
+  }
+  bool pinned = pinToCore(config.cpu);
+  if (config.counters && !perfCounters::supported())
+    cout << "perf_event_open no disponible (¿perf_event_paranoid?): contadores a NAN" << endl;
+
+  vector<size_t> sizes;
+  for (size_t n = 1000; n <= maxN; n *= 10) {
+    sizes.push_back(n);
+    if (5 * n <= maxN) sizes.push_back(5 * n);
+  }
+  if (sizes.empty() || sizes.back() != maxN) sizes.push_back(maxN);
+
+  cout << "Trials: " << config.trials << " (+" << config.warmup << " warmup), "
+       << config.batch << " ops per sample, timer overhead " << timerOverhead() << " ns"
+       << (pinned ? ", pinned to CPU " + to_string(config.cpu) : string(", not pinned")) << endl;
+
+  vector<benchRecord> records;
+  for (size_t n : sizes) {
+    cout << "\nn = " << n << endl;
+    benchInputs in = makeInputs(wl, n, order);
+    if (in.degenerate) cout << "  (nodeTree y leafTree omitidos: orden degenerado)" << endl;
+    benchNodeTrees(in, config, records);
+    benchAVL(in, config, records);
+    benchRBTrees(in, config, records);
+    benchStdMap(in, config, records);
+    printTable(records, n, config);
+  }
+
+  ofstream csv("tree_results.csv");
+  writeCsv(csv, records);
+  ofstream json("tree_results.json");
+  writeJson(json, config, pinned, records);
+  cout << "\nResults saved to 'tree_results.csv' and 'tree_results.json'" << endl;
+  return 0;
+}
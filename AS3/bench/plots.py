@@ -0,0 +1,48 @@
+import os
+import pandas as pd
+import matplotlib.pyplot as plt
+
+# Lee el CSV de treeBench (una fila por árbol, operación y n)
+df = pd.read_csv('./tree_results.csv')
+
+ops = [('insert', 'Inserción'), ('find_hit', 'Búsqueda exitosa'),
+       ('find_miss', 'Búsqueda fallida'), ('delete', 'Borrado')]
+
+fig, axes = plt.subplots(2, 2, figsize=(15, 12))
+fig.suptitle('Comparación de todos los árboles', fontsize=16, fontweight='bold')
+for ax, (op, title) in zip(axes.flat, ops):
+    for tree, rows in df[df['op'] == op].groupby('tree', sort=False):
+        rows = rows.sort_values('n')
+        ax.plot(rows['n'], rows['mean_ns'], 'o-', label=tree, markersize=4)
+        ax.fill_between(rows['n'], rows['ci95_low_ns'], rows['ci95_high_ns'], alpha=0.2)
+    ax.set_xscale('log')
+    ax.set_title(title)
+    ax.set_xlabel('n (número de claves)')
+    ax.set_ylabel('tiempo medio (ns/op)')
+    ax.legend()
+    ax.grid(True)
+
+plt.tight_layout()
+plt.savefig('tree_results.png', dpi=300, bbox_inches='tight')
+plt.show()
+
+# Modo --memory: bytes por clave según el heap de malloc y según memory_usage()
+if os.path.exists('./memory_results.csv'):
+    mem = pd.read_csv('./memory_results.csv')
+    fig, axes = plt.subplots(1, 2, figsize=(15, 6))
+    fig.suptitle('Memoria por clave', fontsize=16, fontweight='bold')
+    for tree, rows in mem.groupby('tree', sort=False):
+        rows = rows.sort_values('n')
+        axes[0].plot(rows['n'], rows['heap_bytes'] / rows['n'], 'o-', label=tree, markersize=4)
+        axes[1].plot(rows['n'], (rows['peak_rss'] - rows['rss_before']) / rows['n'], 'o-',
+                     label=tree, markersize=4)
+    for ax, title in zip(axes, ['Heap de malloc', 'Crecimiento del pico de RSS']):
+        ax.set_xscale('log')
+        ax.set_title(title)
+        ax.set_xlabel('n (número de claves)')
+        ax.set_ylabel('bytes/clave')
+        ax.legend()
+        ax.grid(True)
+    plt.tight_layout()
+    plt.savefig('memory_results.png', dpi=300, bbox_inches='tight')
+    plt.show()
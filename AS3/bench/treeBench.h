@@ -0,0 +1,135 @@
+#ifndef TREEBENCH_H
+#define TREEBENCH_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "../common/benchHarness.h"
+#include "../common/memoryProbe.h"
+#include "../common/memoryUsage.h"
+#include "../common/workload.h"
+
+// Benchmark común a todos los árboles del repositorio (ver main.cpp).
+// Cada estructura se mide con las mismas claves y la misma configuración,
+// y produce una fila de benchRecord por operación: insert, find_hit,
+// find_miss y delete.
+
+struct benchInputs {
+  std::vector<int> keys;    // orden de inserción
+  std::vector<int> hits;    // búsquedas de claves presentes
+  std::vector<int> misses;  // búsquedas de claves ausentes
+  std::vector<int> deletes; // orden de borrado
+  bool degenerate = false;  // orden con el que los árboles sin equilibrar tienen altura ~n
+};
+
+// Adaptador común. Por defecto, la interfaz de nodeTree: insert(k, v), find
+// que devuelve un puntero y deleteNode(k). Se especializa donde difiere.
+template<typename Tree>
+struct treeAdapter {
+  static void insert(Tree& t, int k, int v) { t.insert(k, v); }
+  static bool find(Tree& t, int k) { return t.find(k) != nullptr; }
+  static void erase(Tree& t, int k) { t.deleteNode(k); }
+};
+
+template<>
+struct treeAdapter<std::map<int, int>> {
+  static void insert(std::map<int, int>& t, int k, int v) { t.insert_or_assign(k, v); }
+  static bool find(std::map<int, int>& t, int k) { return t.find(k) != t.end(); }
+  static void erase(std::map<int, int>& t, int k) { t.erase(k); }
+};
+
+// Evita que el compilador elimine las búsquedas
+inline volatile bool benchSink;
+
+template<typename Tree>
+void benchTree(const std::string& name, const benchInputs& in, const benchConfig& cfg,
+               std::vector<benchRecord>& out)
+{
+  using A = treeAdapter<Tree>;
+  size_t n = in.keys.size();
+  std::unique_ptr<Tree> tree;
+  auto fresh = [&] { tree = std::make_unique<Tree>(); };
+  auto full = [&] {
+    fresh();
+    for (int k : in.keys) A::insert(*tree, k, k);
+  };
+  auto nothing = [] {};
+
+  out.push_back({name, "insert", n,
+    runBench(cfg, in.keys, fresh, [&](int k) { A::insert(*tree, k, k); })});
+  // el último ensayo de inserción deja el árbol lleno
+  out.push_back({name, "find_hit", n,
+    runBench(cfg, in.hits, nothing, [&](int k) { benchSink = A::find(*tree, k); })});
+  out.push_back({name, "find_miss", n,
+    runBench(cfg, in.misses, nothing, [&](int k) { benchSink = A::find(*tree, k); })});
+  out.push_back({name, "delete", n,
+    runBench(cfg, in.deletes, full, [&](int k) { A::erase(*tree, k); })});
+}
+
+// Memoria de un árbol construido con n claves (modo --memory de main.cpp)
+struct memoryRecord {
+  std::string tree;
+  size_t n = 0;
+  memoryUsage usage;    // memory_usage() del árbol; a cero si no la tiene (std::map)
+  size_t heapBytes = 0; // lo que creció el heap de malloc al construirlo
+  size_t rssBefore = 0; // memoria residente antes de construirlo
+  size_t peakRss = 0;   // pico de memoria residente hasta destruirlo
+};
+
+// Cada medida se hace en un proceso hijo, que empieza con el heap y el pico
+// de RSS del padre y no hereda la memoria liberada por el árbol anterior.
+// El hijo construye el árbol, mide y manda el resultado por una tubería.
+template<typename Tree>
+void memoryTree(const std::string& name, const std::vector<int>& keys, std::vector<memoryRecord>& out)
+{
+#ifdef __linux__
+  struct measure {
+    memoryUsage usage;
+    size_t heapBytes, rssBefore, peakRss;
+  };
+  int fd[2];
+  if (pipe(fd) != 0) return;
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    measure m{};
+    resetPeakRss();
+    m.rssBefore = currentRss();
+    size_t heapBefore = heapInUse();
+    {
+      std::unique_ptr<Tree> tree = std::make_unique<Tree>();
+      for (int k : keys) treeAdapter<Tree>::insert(*tree, k, k);
+      m.heapBytes = heapInUse() - heapBefore;
+      if constexpr (requires { tree->memory_usage(); }) m.usage = tree->memory_usage();
+      m.peakRss = peakRss();
+    }
+    bool ok = write(fd[1], &m, sizeof(m)) == ssize_t(sizeof(m));
+    _exit(ok ? 0 : 1);
+  }
+  close(fd[1]);
+  measure m{};
+  bool ok = pid > 0 && read(fd[0], &m, sizeof(m)) == ssize_t(sizeof(m));
+  close(fd[0]);
+  if (pid > 0) waitpid(pid, nullptr, 0);
+  if (ok) out.push_back({name, keys.size(), m.usage, m.heapBytes, m.rssBefore, m.peakRss});
+#else
+  (void)name; (void)keys; (void)out;
+#endif
+}
+
+// Una función por familia, cada una en su propia unidad de traducción:
+// AVL/ y NodeTree/ definen clases con el mismo nombre (nodeTree, leafTree).
+void benchNodeTrees(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out);
+void benchAVL(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out);
+void benchRBTrees(const benchInputs& in, const benchConfig& cfg, std::vector<benchRecord>& out);
+
+void memoryNodeTrees(const std::vector<int>& keys, std::vector<memoryRecord>& out);
+void memoryAVL(const std::vector<int>& keys, std::vector<memoryRecord>& out);
+void memoryRBTrees(const std::vector<int>& keys, std::vector<memoryRecord>& out);
+
+#endif
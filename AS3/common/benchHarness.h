@@ -0,0 +1,307 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "latencyHistogram.h"
+#include "perfCounters.h"
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Medición por lotes para los benchmarks de los árboles.
+//
+// Cada muestra es el tiempo de un lote de operaciones consecutivas, menos el
+// coste de leer el reloj, dividido entre el tamaño del lote: con operaciones
+// de 50-200 ns, cronometrarlas una a una mide sobre todo el temporizador.
+// Un experimento repite la secuencia completa en varios ensayos, precedidos
+// de otros de calentamiento que se descartan. El intervalo de confianza de
+// la media sale de las medias de cada ensayo, que son independientes entre
+// sí; las muestras de un mismo ensayo no lo son.
+//
+// Los percentiles son de lotes, no de operaciones sueltas: describen la
+// variación entre tramos de la secuencia, no la cola de latencia individual.
+// Para la cola, con latency activado se hacen después pasadas extra que
+// cronometran cada operación por separado y la apuntan en un
+// latencyHistogram; no cuentan para la media ni para los contadores. A cada
+// medida se le resta el coste del reloj, pero su ruido (unos ns) sigue ahí:
+// lo que importa de estas cifras es la cola, no p50.
+//
+// Con counters activado se cuentan además eventos hardware (ver
+// perfCounters.h) durante los ensayos medidos, sin prepare(). Incluyen las
+// lecturas del reloj entre lotes: unas decenas de instrucciones por lote.
+
+struct benchConfig {
+  size_t batch = 1000;     // operaciones por muestra
+  int warmup = 1;          // ensayos de calentamiento
+  int trials = 5;          // ensayos medidos
+  size_t minOps = 100000;  // con n pequeño se añaden ensayos hasta llegar aquí
+  int cpu = 0;             // núcleo al que fijar el hilo; -1 para no fijarlo
+  bool counters = false;   // contadores hardware por operación
+  bool latency = true;     // percentiles de operaciones sueltas
+};
+
+// Latencias de operaciones sueltas en ns (NAN si no se midieron)
+struct latencyPercentiles {
+  size_t ops = 0;
+  double p50 = NAN, p90 = NAN, p99 = NAN, p999 = NAN, max = NAN;
+};
+
+// Todos los tiempos en ns por operación
+struct benchStats {
+  size_t samples = 0;
+  int trials = 0;
+  double mean = 0, stddev = 0, median = 0, min = 0, max = 0;
+  double p5 = 0, p25 = 0, p75 = 0, p95 = 0, p99 = 0;
+  double ciLow = 0, ciHigh = 0; // intervalo de confianza del 95% de la media
+  perfCounts counters;          // NAN si no se pidieron o no hay contadores
+  latencyPercentiles latency;
+};
+
+struct benchRecord {
+  std::string tree;
+  std::string op;
+  size_t n;
+  benchStats stats;
+};
+
+// Fija el hilo actual a un núcleo. Devuelve false si no se pudo (o si el
+// sistema no lo permite).
+inline bool pinToCore(int cpu)
+{
+#ifdef __linux__
+  if (cpu < 0) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+// Mediana del tiempo entre dos lecturas seguidas del reloj, en ns
+inline double timerOverhead()
+{
+  static const double overhead = [] {
+    using clock = std::chrono::steady_clock;
+    std::vector<double> t(1001);
+    for (double& x : t) {
+      auto a = clock::now();
+      auto b = clock::now();
+      x = std::chrono::duration<double, std::nano>(b - a).count();
+    }
+    std::nth_element(t.begin(), t.begin() + t.size() / 2, t.end());
+    return t[t.size() / 2];
+  }();
+  return overhead;
+}
+
+// Percentil p en [0, 1] de un vector ordenado, interpolando entre vecinos
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty()) return 0;
+  double pos = p * (sorted.size() - 1);
+  size_t i = size_t(pos);
+  if (i + 1 >= sorted.size()) return sorted.back();
+  return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+// t de Student para un intervalo del 95% con df grados de libertad
+inline double studentT95(size_t df)
+{
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (df == 0) return 0;
+  return df <= 30 ? table[df - 1] : 1.96;
+}
+
+inline benchStats summarize(std::vector<double> samples, const std::vector<double>& trialMeans)
+{
+  benchStats s;
+  s.samples = samples.size();
+  s.trials = int(trialMeans.size());
+  if (samples.empty()) return s;
+
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double x : samples) sum += x;
+  double sampleMean = sum / samples.size();
+  double sq = 0;
+  for (double x : samples) sq += (x - sampleMean) * (x - sampleMean);
+  s.stddev = samples.size() > 1 ? std::sqrt(sq / (samples.size() - 1)) : 0;
+  s.min = samples.front();
+  s.max = samples.back();
+  s.median = percentile(samples, 0.5);
+  s.p5 = percentile(samples, 0.05);
+  s.p25 = percentile(samples, 0.25);
+  s.p75 = percentile(samples, 0.75);
+  s.p95 = percentile(samples, 0.95);
+  s.p99 = percentile(samples, 0.99);
+
+  // La media global pondera igual cada operación: es la media de los ensayos
+  size_t k = trialMeans.size();
+  double m = 0;
+  for (double x : trialMeans) m += x;
+  m /= k;
+  double var = 0;
+  for (double x : trialMeans) var += (x - m) * (x - m);
+  double half = k > 1 ? studentT95(k - 1) * std::sqrt(var / (k - 1) / k) : 0;
+  s.mean = m;
+  s.ciLow = m - half;
+  s.ciHigh = m + half;
+  return s;
+}
+
+inline latencyPercentiles summarize(const latencyHistogram& h)
+{
+  latencyPercentiles l;
+  l.ops = h.count();
+  if (l.ops == 0) return l;
+  l.p50 = h.percentile(0.5);
+  l.p90 = h.percentile(0.9);
+  l.p99 = h.percentile(0.99);
+  l.p999 = h.percentile(0.999);
+  l.max = double(h.max());
+  return l;
+}
+
+// Ejecuta op(key) para cada clave de keys, en lotes de cfg.batch, durante
+// cfg.warmup + cfg.trials ensayos. prepare() se llama antes de cada ensayo,
+// fuera del tiempo medido, para dejar el estado de partida (p. ej. un árbol
+// vacío antes de insertar o uno lleno antes de borrar). Con cfg.latency
+// siguen tantas pasadas cronometrando cada operación como hagan falta para
+// llegar a cfg.minOps (al menos una).
+template<typename K, typename Prepare, typename Op>
+benchStats runBench(const benchConfig& cfg, const std::vector<K>& keys, Prepare prepare, Op op)
+{
+  using clock = std::chrono::steady_clock;
+  const double overhead = timerOverhead();
+  size_t n = keys.size();
+  if (n == 0) return benchStats{};
+
+  int trials = std::max(cfg.trials, 1);
+  if (n * trials < cfg.minOps) trials = int((cfg.minOps + n - 1) / n);
+  size_t batch = std::max<size_t>(1, std::min(cfg.batch, n));
+
+  std::unique_ptr<perfCounters> perf;
+  if (cfg.counters) perf = std::make_unique<perfCounters>();
+
+  std::vector<double> samples, trialMeans;
+  samples.reserve(size_t(trials) * ((n + batch - 1) / batch));
+  trialMeans.reserve(trials);
+  for (int t = -cfg.warmup; t < trials; t++) {
+    prepare();
+    if (perf && t >= 0) perf->start();
+    double total = 0;
+    for (size_t i = 0; i < n; i += batch) {
+      size_t end = std::min(n, i + batch);
+      auto start = clock::now();
+      for (size_t j = i; j < end; j++) op(keys[j]);
+      double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+      ns = std::max(ns - overhead, 0.0);
+      total += ns;
+      if (t >= 0) samples.push_back(ns / (end - i));
+    }
+    if (perf && t >= 0) perf->stop();
+    if (t >= 0) trialMeans.push_back(total / n);
+  }
+  benchStats s = summarize(std::move(samples), trialMeans);
+  if (perf) s.counters = perf->perOp(size_t(trials) * n);
+
+  if (cfg.latency) {
+    latencyHistogram hist;
+    size_t passes = std::max<size_t>(1, (cfg.minOps + n - 1) / n);
+    for (size_t t = 0; t < passes; t++) {
+      prepare();
+      for (size_t j = 0; j < n; j++) {
+        auto start = clock::now();
+        op(keys[j]);
+        hist.record(std::chrono::duration<double, std::nano>(clock::now() - start).count() - overhead);
+      }
+    }
+    s.latency = summarize(hist);
+  }
+  return s;
+}
+
+// Una fila por (árbol, operación, n)
+inline void writeCsv(std::ostream& out, const std::vector<benchRecord>& records)
+{
+  out << "tree,op,n,trials,samples,mean_ns,ci95_low_ns,ci95_high_ns,stddev_ns,"
+         "min_ns,p5_ns,p25_ns,median_ns,p75_ns,p95_ns,p99_ns,max_ns,"
+         "instructions_per_op,cycles_per_op,l1d_misses_per_op,llc_misses_per_op,"
+         "dtlb_misses_per_op,branch_misses_per_op,"
+         "latency_ops,latency_p50_ns,latency_p90_ns,latency_p99_ns,latency_p999_ns,latency_max_ns\n";
+  for (const benchRecord& r : records) {
+    const benchStats& s = r.stats;
+    out << r.tree << ',' << r.op << ',' << r.n << ',' << s.trials << ',' << s.samples << ','
+        << s.mean << ',' << s.ciLow << ',' << s.ciHigh << ',' << s.stddev << ','
+        << s.min << ',' << s.p5 << ',' << s.p25 << ',' << s.median << ','
+        << s.p75 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << ','
+        << s.counters.instructions << ',' << s.counters.cycles << ','
+        << s.counters.l1dMisses << ',' << s.counters.llcMisses << ','
+        << s.counters.dtlbMisses << ',' << s.counters.branchMisses << ','
+        << s.latency.ops << ',' << s.latency.p50 << ',' << s.latency.p90 << ','
+        << s.latency.p99 << ',' << s.latency.p999 << ',' << s.latency.max << '\n';
+  }
+}
+
+// NAN no es JSON válido: se escribe null
+inline std::string jsonNumber(double x)
+{
+  if (std::isnan(x)) return "null";
+  std::ostringstream out;
+  out << x;
+  return out.str();
+}
+
+inline void writeJson(std::ostream& out, const benchConfig& cfg, bool pinned,
+                      const std::vector<benchRecord>& records)
+{
+  out << "{\n  \"config\": {\"batch\": " << cfg.batch << ", \"warmup\": " << cfg.warmup
+      << ", \"trials\": " << cfg.trials << ", \"min_ops\": " << cfg.minOps
+      << ", \"cpu\": " << cfg.cpu << ", \"pinned\": " << (pinned ? "true" : "false")
+      << ", \"counters\": " << (cfg.counters ? "true" : "false")
+      << ", \"latency\": " << (cfg.latency ? "true" : "false")
+      << ", \"timer_overhead_ns\": " << timerOverhead() << "},\n  \"results\": [";
+  for (size_t i = 0; i < records.size(); i++) {
+    const benchRecord& r = records[i];
+    const benchStats& s = r.stats;
+    out << (i ? ",\n" : "\n")
+        << "    {\"tree\": \"" << r.tree << "\", \"op\": \"" << r.op << "\", \"n\": " << r.n
+        << ", \"trials\": " << s.trials << ", \"samples\": " << s.samples
+        << ", \"mean_ns\": " << s.mean << ", \"ci95_ns\": [" << s.ciLow << ", " << s.ciHigh << "]"
+        << ", \"stddev_ns\": " << s.stddev << ", \"min_ns\": " << s.min
+        << ", \"percentiles_ns\": {\"p5\": " << s.p5 << ", \"p25\": " << s.p25
+        << ", \"p50\": " << s.median << ", \"p75\": " << s.p75 << ", \"p95\": " << s.p95
+        << ", \"p99\": " << s.p99 << "}, \"max_ns\": " << s.max;
+    const perfCounts& c = s.counters;
+    if (cfg.counters)
+      out << ", \"per_op\": {\"instructions\": " << jsonNumber(c.instructions)
+          << ", \"cycles\": " << jsonNumber(c.cycles)
+          << ", \"l1d_misses\": " << jsonNumber(c.l1dMisses)
+          << ", \"llc_misses\": " << jsonNumber(c.llcMisses)
+          << ", \"dtlb_misses\": " << jsonNumber(c.dtlbMisses)
+          << ", \"branch_misses\": " << jsonNumber(c.branchMisses) << "}";
+    const latencyPercentiles& l = s.latency;
+    if (cfg.latency)
+      out << ", \"latency_ns\": {\"ops\": " << l.ops << ", \"p50\": " << jsonNumber(l.p50)
+          << ", \"p90\": " << jsonNumber(l.p90) << ", \"p99\": " << jsonNumber(l.p99)
+          << ", \"p99.9\": " << jsonNumber(l.p999) << ", \"max\": " << jsonNumber(l.max) << "}";
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef FROZENTREE_H
+#define FROZENTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Instantánea inmutable de un árbol para cargas de sólo lectura.
+//
+// Las claves se guardan en orden de Eytzinger (BFS): los hijos de la
+// posición k están en 2k y 2k+1, así que los primeros niveles comparten
+// líneas de caché y los siguientes se pueden precargar. La búsqueda no tiene
+// saltos condicionales dentro del bucle, por lo que una búsqueda fallida
+// cuesta lo mismo que una exitosa.
+//
+// Se construye en O(n) a partir de las claves ordenadas (recorrido inorden
+// del árbol vivo); ver freeze() en nodeTree, AVLTree y RBNodeTree.
+
+template<typename T, typename B>
+class frozenTree {
+  std::vector<T> keys; // índice 0 sin usar
+  std::vector<B> vals;
+  size_t n;
+
+  // Precarga 4 niveles por debajo: los 16 descendientes de k empiezan en 16k
+  static constexpr size_t PREFETCH_AHEAD = 16;
+
+  public:
+  frozenTree() : keys(1), vals(1), n(0) {}
+  frozenTree(const std::vector<T>& sortedKeys, const std::vector<B>& sortedVals);
+
+  const B* find(const T& key) const;
+  bool contains(const T& key) const { return find(key) != nullptr; }
+  size_t getSize() const { return n; }
+
+  private:
+  size_t fill(const std::vector<T>& sortedKeys, const std::vector<B>& sortedVals, size_t pos, size_t k);
+  void prefetch(size_t k) const;
+};
+
+template<typename T, typename B>
+frozenTree<T,B>::frozenTree(const std::vector<T>& sortedKeys, const std::vector<B>& sortedVals)
+  : keys(sortedKeys.size() + 1), vals(sortedKeys.size() + 1), n(sortedKeys.size())
+{
+  fill(sortedKeys, sortedVals, 0, 1);
+}
+
+// Recorrido inorden del árbol implícito: asigna las claves ordenadas a las
+// posiciones de Eytzinger. Devuelve la siguiente posición de entrada libre.
+template<typename T, typename B>
+size_t frozenTree<T,B>::fill(const std::vector<T>& sortedKeys, const std::vector<B>& sortedVals, size_t pos, size_t k)
+{
+  if (k <= n) {
+    pos = fill(sortedKeys, sortedVals, pos, 2 * k);
+    keys[k] = sortedKeys[pos];
+    vals[k] = sortedVals[pos];
+    pos++;
+    pos = fill(sortedKeys, sortedVals, pos, 2 * k + 1);
+  }
+  return pos;
+}
+
+template<typename T, typename B>
+void frozenTree<T,B>::prefetch(size_t k) const
+{
+  // La dirección puede quedar fuera del vector; una precarga nunca falla
+  uintptr_t addr = reinterpret_cast<uintptr_t>(keys.data()) + k * PREFETCH_AHEAD * sizeof(T);
+  __builtin_prefetch(reinterpret_cast<const void*>(addr));
+}
+
+template<typename T, typename B>
+const B* frozenTree<T,B>::find(const T& key) const
+{
+  size_t k = 1;
+  while (k <= n) {
+    prefetch(k);
+    k = 2 * k + (keys[k] < key);
+  }
+  // Deshacer los giros a la derecha finales: k queda en el sucesor (lower bound)
+  k >>= __builtin_ffsll(~k);
+  if (k != 0 && keys[k] == key) {
+    return &vals[k];
+  }
+  return nullptr;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Histograma de latencias con cubos logarítmicos, al estilo de HdrHistogram.
+// Cada octava [2^e, 2^(e+1)) se parte en SUB cubos iguales, así que el error
+// relativo de cualquier valor es menor que 1/SUB (< 1%) y el coste de
+// registrar es O(1) y sin reservar memoria. Por debajo de SUB los cubos son
+// de 1 ns. Valores a partir de 2^MAX_BITS ns (unos 18 minutos) van al último,
+// que sólo sabe su máximo.
+//
+// Los percentiles devuelven el valor más alto del cubo (nunca por encima del
+// máximo registrado), así que no subestiman la cola.
+
+class latencyHistogram {
+  static constexpr int SUB_BITS = 7;
+  static constexpr uint64_t SUB = uint64_t(1) << SUB_BITS;
+  static constexpr int MAX_BITS = 40;
+  static constexpr size_t BUCKETS = size_t(MAX_BITS - SUB_BITS + 1) * SUB;
+
+  std::vector<uint64_t> counts;
+  uint64_t total = 0;
+  uint64_t maxValue = 0;
+
+  static size_t bucketOf(uint64_t v)
+  {
+    if (v < SUB) return size_t(v);
+    int e = std::bit_width(v) - 1;
+    if (e >= MAX_BITS) return BUCKETS - 1;
+    int shift = e - SUB_BITS;
+    return size_t(shift) * SUB + size_t(v >> shift);
+  }
+
+  // Mayor valor que cae en el cubo i
+  static uint64_t highestOf(size_t i)
+  {
+    int shift = i < SUB ? 0 : int(i / SUB) - 1;
+    uint64_t low = uint64_t(i - size_t(shift) * SUB) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+  }
+
+ public:
+  latencyHistogram() : counts(BUCKETS, 0) {}
+
+  void record(uint64_t ns)
+  {
+    counts[bucketOf(ns)]++;
+    total++;
+    maxValue = std::max(maxValue, ns);
+  }
+
+  void record(double ns) { record(uint64_t(std::max(ns, 0.0) + 0.5)); }
+
+  void merge(const latencyHistogram& other)
+  {
+    for (size_t i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+    total += other.total;
+    maxValue = std::max(maxValue, other.maxValue);
+  }
+
+  void reset()
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = maxValue = 0;
+  }
+
+  uint64_t count() const { return total; }
+  uint64_t max() const { return maxValue; }
+
+  // Percentil p en [0, 1]; NAN si está vacío
+  double percentile(double p) const
+  {
+    if (total == 0) return NAN;
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+      if (seen >= rank) return i + 1 == BUCKETS ? double(maxValue) : double(std::min(highestOf(i), maxValue));
+    }
+    return double(maxValue);
+  }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef MEMORYPROBE_H
+#define MEMORYPROBE_H
+
+#include <cstddef>
+#include <cstdio>
+#ifdef __linux__
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Memoria del proceso actual, para contrastar los memory_usage() de los
+// árboles (sólo Linux; en otro sistema todo vale 0).
+//   heapInUse     bytes entregados por malloc y aún vivos, incluidos los
+//                 bloques grandes servidos con mmap (glibc: mallinfo2)
+//   currentRss    memoria residente ahora
+//   peakRss       pico de memoria residente (VmHWM)
+//   resetPeakRss  lleva el pico a la memoria residente actual
+// Todas en bytes. heapInUse sólo mira la arena principal: basta mientras el
+// proceso no reserve desde otros hilos.
+
+inline size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+inline size_t currentRss()
+{
+#ifdef __linux__
+  size_t pages = 0, resident = 0;
+  FILE* f = std::fopen("/proc/self/statm", "r");
+  if (f == nullptr) return 0;
+  if (std::fscanf(f, "%zu %zu", &pages, &resident) != 2) resident = 0;
+  std::fclose(f);
+  return resident * size_t(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+inline bool resetPeakRss()
+{
+#ifdef __linux__
+  FILE* f = std::fopen("/proc/self/clear_refs", "w");
+  if (f == nullptr) return false;
+  bool ok = std::fputs("5", f) >= 0;
+  return std::fclose(f) == 0 && ok;
+#else
+  return false;
+#endif
+}
+
+inline size_t peakRss()
+{
+#ifdef __linux__
+  size_t kb = 0;
+  char line[128];
+  FILE* f = std::fopen("/proc/self/status", "r");
+  if (f != nullptr) {
+    while (std::fgets(line, sizeof(line), f) != nullptr)
+      if (std::sscanf(line, "VmHWM: %zu kB", &kb) == 1) break;
+    std::fclose(f);
+  }
+  if (kb == 0) {
+    // sin /proc: el pico de getrusage no se puede reiniciar
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) kb = size_t(ru.ru_maxrss);
+  }
+  return kb * 1024;
+#else
+  return 0;
+#endif
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <algorithm>
+#include <cstddef>
+
+// Memoria de un árbol según memory_usage():
+//   nodeBytes      nodos vivos * sizeof(nodo)
+//   overheadBytes  el resto: huecos de los slabs del pool, cabeceras y
+//                  redondeo de malloc, centinelas y el propio objeto árbol
+//   internalNodes  nodos sólo de enrutado (sin par clave-valor propio)
+//   leafNodes      nodos que guardan un par clave-valor
+// No incluye lo que reserven los valores por su cuenta (B con memoria
+// dinámica) ni las instantáneas de freeze().
+struct memoryUsage {
+  size_t nodeBytes = 0;
+  size_t overheadBytes = 0;
+  size_t internalNodes = 0;
+  size_t leafNodes = 0;
+
+  size_t totalBytes() const { return nodeBytes + overheadBytes; }
+};
+
+// Bytes que reserva malloc de glibc (64 bits) para un bloque de n bytes:
+// 8 de cabecera, múltiplo de 16 y al menos 32
+constexpr size_t heapBlockBytes(size_t n)
+{
+  return std::max<size_t>(32, (n + 8 + 15) & ~size_t(15));
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include "memoryUsage.h"
+
+// Políticas de asignación de nodos para los árboles.
+//
+// nodePool reserva memoria en slabs (bloques de muchos nodos) y guarda los
+// nodos liberados en una lista libre intrusiva para reutilizarlos. Como toda
+// la memoria pertenece al pool, el árbol puede liberarse de golpe con
+// release() sin recorrer nodo por nodo.
+//
+// heapAlloc mantiene el comportamiento clásico (new/delete por nodo).
+//
+// Un pool no es seguro entre hilos. Para liberar desde varios hilos a la vez
+// cada uno acumula sus nodos en su propia chain (retire/reuse no tocan el
+// pool) y al final se devuelven todas con reclaim().
+//
+// Ambas llevan la cuenta de nodos vivos (liveNodes) y de los bytes que
+// ocupan de más respecto a liveNodes() * sizeof(N) (overheadBytes): huecos
+// de los slabs y su índice en nodePool, cabeceras y redondeo de malloc en
+// heapAlloc. Es lo que usan los memory_usage() de los árboles (ver
+// common/memoryUsage.h). Ambas cifras suponen que cada nodo se libera en el
+// pool que lo creó; los árboles del AVL, que liberan en su pool nodos
+// creados en otro, usan en su lugar reservedBytes() y blockBytes.
+
+template<typename N>
+class nodePool {
+  union slot {
+    slot* next;
+    alignas(N) unsigned char storage[sizeof(N)];
+  };
+
+  std::vector<slot*> slabs;
+  slot* freeList;
+  slot* freeTail; // para concatenar listas en splice()
+  slot* cursor;
+  slot* slabEnd;
+  size_t nextSlab;
+  size_t live;     // nodos construidos
+  size_t capacity; // slots en todos los slabs
+
+  public:
+  typedef N node_type;
+  static constexpr bool bulkRelease = true;
+  static constexpr size_t FIRST_SLAB = 64;
+  static constexpr size_t MAX_SLAB = size_t(1) << 16;
+
+  struct chain {
+    slot* head = nullptr;
+    slot* tail = nullptr;
+    size_t count = 0;
+  };
+
+  nodePool() : freeList(nullptr), freeTail(nullptr), cursor(nullptr), slabEnd(nullptr),
+               nextSlab(FIRST_SLAB), live(0), capacity(0) {}
+  ~nodePool() { release(); }
+
+  nodePool(const nodePool&) = delete;
+  nodePool& operator=(const nodePool&) = delete;
+
+  template<typename... Args>
+  N* create(Args&&... args);
+  void destroy(N* n);
+  void release();
+  void splice(nodePool& other);
+
+  static void retire(chain& c, N* n);
+  template<typename... Args>
+  static N* reuse(chain& c, Args&&... args); // nullptr si la chain está vacía
+  void reclaim(chain& c);
+
+  size_t slabCount() const { return slabs.size(); }
+  size_t liveNodes() const { return live; }
+  size_t overheadBytes() const { return reservedBytes() - live * sizeof(N); }
+  // Slabs y su índice; los nodos no ocupan nada fuera de ellos
+  size_t reservedBytes() const { return capacity * sizeof(slot) + slabs.capacity() * sizeof(slot*); }
+  static constexpr size_t blockBytes = 0;
+
+  private:
+  void grow();
+};
+
+template<typename N>
+template<typename... Args>
+N* nodePool<N>::create(Args&&... args)
+{
+  slot* s;
+  if (freeList != nullptr) {
+    s = freeList;
+    freeList = freeList->next;
+    if (freeList == nullptr) freeTail = nullptr;
+  } else {
+    if (cursor == slabEnd) grow();
+    s = cursor++;
+  }
+  N* n = new (s->storage) N(std::forward<Args>(args)...);
+  live++;
+  return n;
+}
+
+template<typename N>
+void nodePool<N>::destroy(N* n)
+{
+  if (n == nullptr) return;
+  n->~N();
+  live--;
+  slot* s = reinterpret_cast<slot*>(n);
+  if (freeList == nullptr) freeTail = s;
+  s->next = freeList;
+  freeList = s;
+}
+
+// Los slabs crecen al doble hasta MAX_SLAB, así que liberar el pool cuesta
+// O(número de slabs) y no O(número de nodos). No ejecuta destructores.
+template<typename N>
+void nodePool<N>::release()
+{
+  for (slot* slab : slabs) {
+    ::operator delete(slab);
+  }
+  slabs.clear();
+  freeList = freeTail = cursor = slabEnd = nullptr;
+  nextSlab = FIRST_SLAB;
+  live = capacity = 0;
+}
+
+// Toma los slabs y la lista libre de other, que queda vacío; los nodos vivos
+// de other pasan a pertenecer a este pool. De los dos slabs en curso se
+// conserva el que tiene más hueco: el resto del otro no se reutiliza hasta
+// release().
+template<typename N>
+void nodePool<N>::splice(nodePool& other)
+{
+  if (this == &other) return;
+  slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+  if (other.freeList != nullptr) {
+    other.freeTail->next = freeList;
+    if (freeList == nullptr) freeTail = other.freeTail;
+    freeList = other.freeList;
+  }
+  if (other.slabEnd - other.cursor > slabEnd - cursor) {
+    cursor = other.cursor;
+    slabEnd = other.slabEnd;
+  }
+  if (other.nextSlab > nextSlab) nextSlab = other.nextSlab;
+  live += other.live;
+  capacity += other.capacity;
+
+  other.slabs.clear();
+  other.freeList = other.freeTail = other.cursor = other.slabEnd = nullptr;
+  other.nextSlab = FIRST_SLAB;
+  other.live = other.capacity = 0;
+}
+
+template<typename N>
+void nodePool<N>::retire(chain& c, N* n)
+{
+  n->~N();
+  slot* s = reinterpret_cast<slot*>(n);
+  if (c.head == nullptr) c.tail = s;
+  s->next = c.head;
+  c.head = s;
+  c.count++;
+}
+
+template<typename N>
+template<typename... Args>
+N* nodePool<N>::reuse(chain& c, Args&&... args)
+{
+  if (c.head == nullptr) return nullptr;
+  slot* s = c.head;
+  c.head = s->next;
+  if (c.head == nullptr) c.tail = nullptr;
+  c.count--;
+  return new (s->storage) N(std::forward<Args>(args)...);
+}
+
+template<typename N>
+void nodePool<N>::reclaim(chain& c)
+{
+  if (c.head == nullptr) return;
+  c.tail->next = freeList;
+  if (freeList == nullptr) freeTail = c.tail;
+  freeList = c.head;
+  live -= c.count;
+  c.head = c.tail = nullptr;
+  c.count = 0;
+}
+
+template<typename N>
+void nodePool<N>::grow()
+{
+  slot* slab = static_cast<slot*>(::operator new(nextSlab * sizeof(slot)));
+  slabs.push_back(slab);
+  cursor = slab;
+  slabEnd = slab + nextSlab;
+  capacity += nextSlab;
+  if (nextSlab < MAX_SLAB) nextSlab *= 2;
+}
+
+template<typename N>
+class heapAlloc {
+  public:
+  typedef N node_type;
+  static constexpr bool bulkRelease = false;
+
+  // new/delete ya son seguros entre hilos: la chain sólo lleva la cuenta
+  // de nodos para reclaim()
+  struct chain {
+    std::ptrdiff_t count = 0;
+  };
+
+  template<typename... Args>
+  N* create(Args&&... args) { N* n = new N(std::forward<Args>(args)...); live++; return n; }
+  void destroy(N* n) { if (n != nullptr) live--; delete n; }
+  void release() {}
+  void splice(heapAlloc& other) { live += other.live; other.live = 0; }
+
+  static void retire(chain& c, N* n) { c.count++; delete n; }
+  template<typename... Args>
+  static N* reuse(chain& c, Args&&... args) { c.count--; return new N(std::forward<Args>(args)...); }
+  void reclaim(chain& c) { live -= c.count; c.count = 0; }
+
+  size_t liveNodes() const { return live; }
+  size_t overheadBytes() const { return live * (blockBytes - sizeof(N)); }
+  size_t reservedBytes() const { return 0; }
+  static constexpr size_t blockBytes = heapBlockBytes(sizeof(N)); // por nodo
+
+  private:
+  size_t live = 0;
+};
+
+#endif
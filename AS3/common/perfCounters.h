@@ -0,0 +1,160 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Contadores hardware del hilo actual mediante perf_event_open (sólo Linux).
+// Cada evento se abre por separado, no en grupo: si la PMU no tiene sitio
+// para todos el núcleo los multiplexa y el valor se escala por la fracción
+// de tiempo que estuvo contando. Sólo se cuenta en modo usuario, lo que
+// basta con perf_event_paranoid <= 2. Un evento que no se pueda abrir (VM,
+// contenedor, PMU sin ese evento) queda como NAN; el resto sigue valiendo.
+
+// Eventos por operación
+struct perfCounts {
+  double instructions = NAN;
+  double cycles = NAN;
+  double l1dMisses = NAN;    // fallos de lectura en L1 de datos
+  double llcMisses = NAN;    // fallos de lectura en el último nivel de caché
+  double dtlbMisses = NAN;   // fallos de lectura en la TLB de datos
+  double branchMisses = NAN; // saltos mal predichos
+};
+
+class perfCounters {
+  static constexpr int EVENTS = 6;
+
+  struct reading {
+    uint64_t value, enabled, running;
+  };
+
+  int fd[EVENTS];
+  reading base[EVENTS];
+
+#ifdef __linux__
+  static int open(uint32_t type, uint64_t config)
+  {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static uint64_t cacheEvent(uint64_t cache)
+  {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+#endif
+
+  reading read(int i) const
+  {
+    reading r{0, 0, 0};
+#ifdef __linux__
+    if (fd[i] >= 0 && ::read(fd[i], &r, sizeof(r)) != ssize_t(sizeof(r))) r = {0, 0, 0};
+#endif
+    return r;
+  }
+
+  void control(unsigned long request)
+  {
+#ifdef __linux__
+    for (int i = 0; i < EVENTS; i++)
+      if (fd[i] >= 0) ioctl(fd[i], request, 0);
+#else
+    (void)request;
+#endif
+  }
+
+ public:
+  perfCounters()
+  {
+    for (int i = 0; i < EVENTS; i++) fd[i] = -1;
+#ifdef __linux__
+    fd[0] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd[1] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fd[2] = open(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D));
+    fd[3] = open(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL));
+    fd[4] = open(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB));
+    fd[5] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    clear();
+  }
+
+  ~perfCounters()
+  {
+#ifdef __linux__
+    for (int i = 0; i < EVENTS; i++)
+      if (fd[i] >= 0) close(fd[i]);
+#endif
+  }
+
+  perfCounters(const perfCounters&) = delete;
+  perfCounters& operator=(const perfCounters&) = delete;
+
+  // true si se pudo abrir al menos un evento
+  bool available() const
+  {
+    for (int i = 0; i < EVENTS; i++)
+      if (fd[i] >= 0) return true;
+    return false;
+  }
+
+  // Comprueba una vez si el sistema deja abrir contadores
+  static bool supported()
+  {
+    static const bool ok = perfCounters().available();
+    return ok;
+  }
+
+#ifdef __linux__
+  void start() { control(PERF_EVENT_IOC_ENABLE); }
+  void stop() { control(PERF_EVENT_IOC_DISABLE); }
+#else
+  void start() {}
+  void stop() {}
+#endif
+
+  // Descarta lo contado hasta ahora
+  void clear()
+  {
+    for (int i = 0; i < EVENTS; i++) base[i] = read(i);
+  }
+
+  // Lo contado desde clear(), dividido entre ops
+  perfCounts perOp(size_t ops) const
+  {
+    double v[EVENTS];
+    for (int i = 0; i < EVENTS; i++) {
+      reading r = read(i);
+      uint64_t running = r.running - base[i].running;
+      if (fd[i] < 0 || running == 0 || ops == 0) {
+        v[i] = NAN;
+        continue;
+      }
+      double scale = double(r.enabled - base[i].enabled) / running;
+      v[i] = double(r.value - base[i].value) * scale / ops;
+    }
+    perfCounts c;
+    c.instructions = v[0];
+    c.cycles = v[1];
+    c.l1dMisses = v[2];
+    c.llcMisses = v[3];
+    c.dtlbMisses = v[4];
+    c.branchMisses = v[5];
+    return c;
+  }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef STATICTREE_H
+#define STATICTREE_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+// Árbol de búsqueda de tamaño fijo construido en compilación, para tablas
+// que se conocen de antemano (opcodes, enum -> manejador...):
+//
+//   constexpr auto ops = makeStaticTree<int, handler>({{1, add}, {2, sub}});
+//   static_assert(ops.find(2) != nullptr);
+//
+// Igual que frozenTree, las claves van en orden de Eytzinger en un array
+// implícito sin punteros (hijos de k en 2k y 2k+1) y la búsqueda no tiene
+// saltos condicionales en el bucle. Todo es constexpr: declarado constexpr
+// el árbol va en la sección de datos y no cuesta nada al arrancar.
+//
+// Como insert en los árboles, una clave repetida se queda con el último
+// valor; size() cuenta claves distintas. T y B deben ser tipos literales
+// con constructor por defecto.
+
+template<typename T, typename B, size_t N>
+class StaticTree {
+  std::array<T, N + 1> keys{}; // índice 0 sin usar
+  std::array<B, N + 1> vals{};
+  size_t n = 0;
+
+  public:
+  constexpr StaticTree() = default;
+  constexpr explicit StaticTree(const std::array<std::pair<T, B>, N>& pairs);
+
+  constexpr const B* find(const T& key) const;
+  constexpr bool contains(const T& key) const { return find(key) != nullptr; }
+  // Menor clave >= key, o nullptr si no hay ninguna
+  constexpr const T* lower_bound(const T& key) const;
+  constexpr size_t size() const { return n; }
+
+  private:
+  constexpr size_t fill(const std::array<std::pair<T, B>, N>& sorted, size_t pos, size_t k);
+  constexpr size_t successor(const T& key) const;
+};
+
+template<typename T, typename B, size_t N>
+constexpr StaticTree<T,B,N>::StaticTree(const std::array<std::pair<T, B>, N>& pairs)
+{
+  // std::stable_sort no es constexpr: se ordenan índices desempatando por
+  // posición, y de cada grupo de repetidas se queda el valor de la última
+  std::array<size_t, N> order{};
+  for (size_t i = 0; i < N; i++) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return pairs[a].first < pairs[b].first || (!(pairs[b].first < pairs[a].first) && a < b);
+  });
+  std::array<std::pair<T, B>, N> sorted{};
+  for (size_t i = 0; i < N; i++) {
+    const std::pair<T, B>& p = pairs[order[i]];
+    if (n > 0 && !(sorted[n - 1].first < p.first)) sorted[n - 1].second = p.second;
+    else sorted[n++] = p;
+  }
+  fill(sorted, 0, 1);
+}
+
+// Recorrido inorden del árbol implícito, como frozenTree::fill
+template<typename T, typename B, size_t N>
+constexpr size_t StaticTree<T,B,N>::fill(const std::array<std::pair<T, B>, N>& sorted, size_t pos, size_t k)
+{
+  if (k <= n) {
+    pos = fill(sorted, pos, 2 * k);
+    keys[k] = sorted[pos].first;
+    vals[k] = sorted[pos].second;
+    pos++;
+    pos = fill(sorted, pos, 2 * k + 1);
+  }
+  return pos;
+}
+
+// Posición de la menor clave >= key, 0 si no hay ninguna
+template<typename T, typename B, size_t N>
+constexpr size_t StaticTree<T,B,N>::successor(const T& key) const
+{
+  size_t k = 1;
+  while (k <= n) {
+    k = 2 * k + (keys[k] < key);
+  }
+  // Deshacer los giros a la derecha finales: k queda en el sucesor
+  return k >> (std::countr_one(k) + 1);
+}
+
+template<typename T, typename B, size_t N>
+constexpr const B* StaticTree<T,B,N>::find(const T& key) const
+{
+  size_t k = successor(key);
+  if (k != 0 && keys[k] == key) {
+    return &vals[k];
+  }
+  return nullptr;
+}
+
+template<typename T, typename B, size_t N>
+constexpr const T* StaticTree<T,B,N>::lower_bound(const T& key) const
+{
+  size_t k = successor(key);
+  return k != 0 ? &keys[k] : nullptr;
+}
+
+// Deduce N de la lista: makeStaticTree<int, int>({{1, 10}, {2, 20}})
+template<typename T, typename B, size_t N>
+constexpr StaticTree<T,B,N> makeStaticTree(const std::pair<T, B> (&pairs)[N])
+{
+  std::array<std::pair<T, B>, N> a{};
+  for (size_t i = 0; i < N; i++) a[i] = pairs[i];
+  return StaticTree<T,B,N>(a);
+}
+
+#endif
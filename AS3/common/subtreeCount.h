@@ -0,0 +1,18 @@
+#ifndef SUBTREECOUNT_H
+#define SUBTREECOUNT_H
+
+#include <cstddef>
+#include <type_traits>
+
+// Tamaño del subárbol guardado en cada nodo, para los árboles con
+// estadísticas de orden (select/rank). Sin ellas el campo es noCount, que
+// con [[no_unique_address]] no ocupa nada:
+//   [[no_unique_address]] subtreeCount<Ranked> count;
+struct noCount {
+  constexpr noCount(size_t) {}
+};
+
+template<bool Ranked>
+using subtreeCount = std::conditional_t<Ranked, size_t, noCount>;
+
+#endif
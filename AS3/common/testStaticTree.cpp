@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "staticTree.h"
+
+//   g++ -std=c++20 -O2 testStaticTree.cpp -o testStaticTree
+
+// Construido en compilación, desordenado y con una clave repetida
+constexpr auto ops = makeStaticTree<int, int>({{30, 3}, {10, 1}, {50, 5}, {20, 2}, {40, 4}, {10, 9}});
+static_assert(ops.size() == 5);
+static_assert(ops.contains(20) && *ops.find(20) == 2);
+static_assert(ops.contains(10) && *ops.find(10) == 9); // primera, gana el último valor
+static_assert(ops.contains(50) && *ops.find(50) == 5); // última
+static_assert(ops.find(25) == nullptr && !ops.contains(0) && !ops.contains(60));
+static_assert(*ops.lower_bound(25) == 30);
+static_assert(*ops.lower_bound(0) == 10 && *ops.lower_bound(50) == 50);
+static_assert(ops.lower_bound(51) == nullptr);
+
+constexpr StaticTree<int, int, 0> empty(std::array<std::pair<int, int>, 0>{});
+static_assert(empty.size() == 0 && empty.find(0) == nullptr && empty.lower_bound(0) == nullptr);
+
+constexpr auto single = makeStaticTree<int, int>({{7, 70}});
+static_assert(*single.find(7) == 70 && *single.lower_bound(3) == 7 && single.lower_bound(8) == nullptr);
+
+int main() {
+  // find y lower_bound frente a std::lower_bound sobre las mismas claves,
+  // con un tamaño que no llena el último nivel
+  constexpr size_t N = 300;
+  std::mt19937 rng(5);
+  std::array<std::pair<int, int>, N> pairs{};
+  for (size_t i = 0; i < N; i++) pairs[i] = {int(rng() % 1000), int(i)};
+  StaticTree<int, int, N> tree(pairs);
+
+  std::vector<int> sorted;
+  for (auto [k, v] : pairs) sorted.push_back(k);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  assert(tree.size() == sorted.size());
+
+  for (int key = -1; key <= 1001; key++) {
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), key);
+    const int* lb = tree.lower_bound(key);
+    assert((lb == nullptr) == (it == sorted.end()));
+    if (lb) assert(*lb == *it);
+    assert(tree.contains(key) == (it != sorted.end() && *it == key));
+  }
+
+  std::cout << "Pruebas básicas superadas.\n";
+}
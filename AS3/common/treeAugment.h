@@ -0,0 +1,77 @@
+#ifndef TREEAUGMENT_H
+#define TREEAUGMENT_H
+
+#include <algorithm>
+#include <limits>
+
+// Agregados por subárbol (sumas, mínimos, máximos...) como parámetro de
+// plantilla, igual que Stats. Un Augment es un monoide sobre los pares:
+//   value_type       tipo del agregado
+//   identity()       neutro de combine (el agregado de un subárbol vacío)
+//   lift(key, val)   agregado de un solo par
+//   combine(a, b)    a seguido de b en orden de clave; asociativa, no hace
+//                    falta que sea conmutativa
+// Cada nodo guarda combine de su subárbol izquierdo, su par y el derecho.
+//
+// noAugment, el valor por defecto, no guarda nada: value_type es vacío y el
+// nodo lo declara [[no_unique_address]], así que no cambia de tamaño.
+
+struct noAugment {
+  static constexpr bool enabled = false;
+  struct value_type {};
+
+  static value_type identity() { return {}; }
+  template<typename K, typename V>
+  static value_type lift(const K&, const V&) { return {}; }
+  static value_type combine(value_type, value_type) { return {}; }
+};
+
+template<typename V>
+struct sumAugment {
+  static constexpr bool enabled = true;
+  typedef V value_type;
+
+  static V identity() { return V{}; }
+  template<typename K>
+  static V lift(const K&, const V& val) { return val; }
+  static V combine(const V& a, const V& b) { return a + b; }
+};
+
+template<typename V>
+struct minAugment {
+  static constexpr bool enabled = true;
+  typedef V value_type;
+
+  static V identity() { return std::numeric_limits<V>::max(); }
+  template<typename K>
+  static V lift(const K&, const V& val) { return val; }
+  static V combine(const V& a, const V& b) { return std::min(a, b); }
+};
+
+template<typename V>
+struct maxAugment {
+  static constexpr bool enabled = true;
+  typedef V value_type;
+
+  static V identity() { return std::numeric_limits<V>::lowest(); }
+  template<typename K>
+  static V lift(const K&, const V& val) { return val; }
+  static V combine(const V& a, const V& b) { return std::max(a, b); }
+};
+
+// Árboles de intervalos: las claves son pares (inicio, fin), intervalos
+// cerrados ordenados por inicio, y el agregado es el mayor fin del
+// subárbol. Con él RBNodeTree ofrece overlaps y stab (ver RBIntervalTree).
+template<typename V>
+struct intervalAugment {
+  static constexpr bool enabled = true;
+  static constexpr bool interval = true;
+  typedef V value_type;
+
+  static V identity() { return std::numeric_limits<V>::lowest(); }
+  template<typename K, typename B>
+  static V lift(const K& key, const B&) { return key.second; }
+  static V combine(const V& a, const V& b) { return std::max(a, b); }
+};
+
+#endif
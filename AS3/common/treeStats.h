@@ -0,0 +1,96 @@
+#ifndef TREESTATS_H
+#define TREESTATS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Estadísticas de operación de los árboles, como parámetro de plantilla.
+//
+// noStats, el valor por defecto, no guarda nada: sus métodos están vacíos y
+// desaparecen al compilar, y el árbol lo declara [[no_unique_address]], así
+// que tampoco ocupa sitio. Con countingStats se cuentan:
+//   comparisons  comparaciones de claves (cada <, == o <= evaluado)
+//   rotations    rotaciones simples (una doble cuenta dos)
+//   recolors     cambios de color (sólo en los rojinegros)
+//   visits       nodos recorridos por find, insert y erase/deleteNode
+//   fixups       vueltas de los bucles de reequilibrado (insertFix y
+//                deleteFix de los rojinegros, retrace de AVLTree)
+// y un histograma del número de nodos que visita cada find.
+//
+// No se instrumentan find_batch, la carga ordenada ni las operaciones de
+// conjuntos (éstas corren en varios hilos y los contadores no son atómicos).
+
+struct statsSnapshot {
+  size_t comparisons = 0;
+  size_t rotations = 0;
+  size_t recolors = 0;
+  size_t visits = 0;
+  size_t fixups = 0;
+  size_t searches = 0;
+  // depthHistogram[d]: búsquedas que visitaron d nodos (la última casilla
+  // acumula las más profundas)
+  std::vector<size_t> depthHistogram;
+
+  double meanSearchDepth() const {
+    size_t total = 0;
+    for (size_t d = 0; d < depthHistogram.size(); d++) total += d * depthHistogram[d];
+    return searches ? double(total) / searches : 0;
+  }
+};
+
+struct noStats {
+  static constexpr bool enabled = false;
+
+  void compare(size_t = 1) {}
+  void rotate() {}
+  void recolor(size_t = 1) {}
+  void visit() {}
+  void fixup() {}
+  void beginSearch() {}
+  void endSearch() {}
+  void reset() {}
+  statsSnapshot snapshot() const { return {}; }
+};
+
+class countingStats {
+  static constexpr size_t MAX_DEPTH = 128;
+
+  size_t comparisons = 0, rotations = 0, recolors = 0, visits = 0, fixups = 0;
+  size_t searches = 0, searchStart = 0;
+  size_t depth[MAX_DEPTH] = {};
+
+ public:
+  static constexpr bool enabled = true;
+
+  void compare(size_t n = 1) { comparisons += n; }
+  void rotate() { rotations++; }
+  void recolor(size_t n = 1) { recolors += n; }
+  void visit() { visits++; }
+  void fixup() { fixups++; }
+
+  // Una búsqueda: los nodos que se visiten entre las dos llamadas
+  void beginSearch() { searchStart = visits; }
+  void endSearch() {
+    searches++;
+    depth[std::min(visits - searchStart, MAX_DEPTH - 1)]++;
+  }
+
+  void reset() { *this = countingStats(); }
+
+  statsSnapshot snapshot() const {
+    statsSnapshot s;
+    s.comparisons = comparisons;
+    s.rotations = rotations;
+    s.recolors = recolors;
+    s.visits = visits;
+    s.fixups = fixups;
+    s.searches = searches;
+    size_t used = MAX_DEPTH;
+    while (used > 0 && depth[used - 1] == 0) used--;
+    s.depthHistogram.assign(depth, depth + used);
+    return s;
+  }
+};
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool de hilos fork-join con robo de trabajo para los algoritmos de divide y
+// vencerás sobre árboles (union_with y compañía).
+//
+// run(f) ejecuta f en el hilo llamador, que actúa como trabajador 0 mientras
+// dure. Dentro, invoke(f, g) deja g en la cola del hilo actual, ejecuta f y
+// luego recupera g; si otro hilo la ha robado, ayuda con otras tareas hasta
+// que termine. Cada hilo saca de su cola por el final (LIFO) y roba de las
+// demás por el principio, así que se roban las tareas más grandes.
+//
+// Las colas usan un mutex cada una: las tareas son gruesas (subárboles
+// enteros) y el coste del bloqueo queda oculto.
+
+class workStealingPool {
+  struct task {
+    void (*call)(void*);
+    void* arg;
+    std::atomic<bool> done;
+  };
+
+  struct queue {
+    std::mutex m;
+    std::deque<task*> tasks;
+  };
+
+  std::vector<std::unique_ptr<queue>> queues;
+  std::vector<std::thread> threads;
+  std::mutex runMutex; // un solo run() a la vez
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  std::atomic<bool> active;
+  bool stopping;
+
+  inline static thread_local workStealingPool* current = nullptr;
+  inline static thread_local unsigned index = 0;
+
+  public:
+  explicit workStealingPool(unsigned workers = std::thread::hardware_concurrency());
+  ~workStealingPool();
+
+  workStealingPool(const workStealingPool&) = delete;
+  workStealingPool& operator=(const workStealingPool&) = delete;
+
+  unsigned size() const { return unsigned(queues.size()); }
+  // Índice del trabajador que ejecuta el código actual, en [0, size())
+  static unsigned currentWorker() { return index; }
+
+  template<typename F>
+  void run(F&& f);
+  template<typename F, typename G>
+  void invoke(F&& f, G&& g);
+
+  // Pool compartido con un hilo por núcleo
+  static workStealingPool& global();
+
+  private:
+  void workerLoop(unsigned i);
+  bool runOne(unsigned i);
+  static void execute(task* t);
+
+  template<typename G>
+  static void callTask(void* g) { (*static_cast<G*>(g))(); }
+};
+
+inline workStealingPool::workStealingPool(unsigned workers) : active(false), stopping(false)
+{
+  if (workers == 0) workers = 1;
+  for (unsigned i = 0; i < workers; i++) {
+    queues.push_back(std::make_unique<queue>());
+  }
+  for (unsigned i = 1; i < workers; i++) {
+    threads.emplace_back(&workStealingPool::workerLoop, this, i);
+  }
+}
+
+inline workStealingPool::~workStealingPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& t : threads) t.join();
+}
+
+inline workStealingPool& workStealingPool::global()
+{
+  static workStealingPool pool;
+  return pool;
+}
+
+template<typename F>
+void workStealingPool::run(F&& f)
+{
+  std::lock_guard<std::mutex> guard(runMutex);
+  workStealingPool* prevPool = current;
+  unsigned prevIndex = index;
+  current = this;
+  index = 0;
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    active.store(true);
+  }
+  wake.notify_all();
+
+  f();
+
+  active.store(false);
+  current = prevPool;
+  index = prevIndex;
+}
+
+template<typename F, typename G>
+void workStealingPool::invoke(F&& f, G&& g)
+{
+  if (current != this || size() == 1) {
+    f();
+    g();
+    return;
+  }
+
+  task t{&callTask<std::remove_reference_t<G>>, &g, {false}};
+  queue& q = *queues[index];
+  {
+    std::lock_guard<std::mutex> lock(q.m);
+    q.tasks.push_back(&t);
+  }
+
+  f();
+
+  // Las tareas encoladas por f ya se han recuperado: si t no está al final
+  // es que alguien la robó
+  bool stolen;
+  {
+    std::lock_guard<std::mutex> lock(q.m);
+    stolen = q.tasks.empty() || q.tasks.back() != &t;
+    if (!stolen) q.tasks.pop_back();
+  }
+  if (!stolen) {
+    g();
+    return;
+  }
+  while (!t.done.load(std::memory_order_acquire)) {
+    if (!runOne(index)) std::this_thread::yield();
+  }
+}
+
+inline void workStealingPool::execute(task* t)
+{
+  t->call(t->arg);
+  t->done.store(true, std::memory_order_release);
+}
+
+// Primero la cola propia por el final; si está vacía, robar por el principio
+inline bool workStealingPool::runOne(unsigned i)
+{
+  task* t = nullptr;
+  {
+    queue& own = *queues[i];
+    std::lock_guard<std::mutex> lock(own.m);
+    if (!own.tasks.empty()) {
+      t = own.tasks.back();
+      own.tasks.pop_back();
+    }
+  }
+  for (unsigned k = 1; t == nullptr && k < size(); k++) {
+    queue& victim = *queues[(i + k) % size()];
+    std::lock_guard<std::mutex> lock(victim.m);
+    if (!victim.tasks.empty()) {
+      t = victim.tasks.front();
+      victim.tasks.pop_front();
+    }
+  }
+  if (t == nullptr) return false;
+  execute(t);
+  return true;
+}
+
+// Fuera de run() los trabajadores duermen; dentro, buscan tareas sin parar
+inline void workStealingPool::workerLoop(unsigned i)
+{
+  current = this;
+  index = i;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wake.wait(lock, [this] { return stopping || active.load(); });
+      if (stopping) return;
+    }
+    while (active.load()) {
+      if (!runOne(i)) std::this_thread::yield();
+    }
+  }
+}
+
+#endif
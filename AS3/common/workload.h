@@ -0,0 +1,226 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cargas deterministas para los benchmarks.
+//
+// Las claves se derivan de su rango: la clave presente de rango r es 2r y
+// las ausentes son impares. Así generar n claves distintas es O(n) sin
+// conjuntos auxiliares (1e8 claves en orden uniforme: unos 4 s) y las búsquedas
+// fallidas caen entre claves reales en vez de fuera del rango. Lo que
+// distingue a cada carga es el orden en que se presentan los rangos.
+//
+// Todo sale de splitmix64 con una semilla fija: las distribuciones de <random>
+// no dan la misma secuencia en todas las bibliotecas estándar. Cada método
+// deriva su generador de (semilla, stream), así que el resultado no depende
+// del orden de las llamadas.
+
+// Generador de 64 bits de Steele, Lea y Flood (SplitMix)
+struct splitmix64 {
+  uint64_t state;
+
+  explicit splitmix64(uint64_t seed) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+  // Entero en [0, n) por multiplicación (Lemire), sin división
+  uint64_t below(uint64_t n) { return uint64_t((unsigned __int128)next() * n >> 64); }
+  // Real en [0, 1)
+  double unit() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+// Zipf de exponente theta sobre [0, n), como el ZipfianGenerator de YCSB
+// (Gray et al., "Quickly generating billion-record synthetic databases").
+// zeta(n) se suma exacta hasta 1e6 términos y el resto se aproxima por
+// Euler-Maclaurin; cada muestra es O(1). El rango 0 es el más frecuente.
+class zipfian {
+  size_t n;
+  double theta, alpha, zetan, eta;
+
+  static double zeta(size_t n, double theta) {
+    const size_t exact = std::min<size_t>(n, 1000000);
+    double sum = 0;
+    for (size_t i = 1; i <= exact; i++) sum += std::pow(double(i), -theta);
+    if (n > exact) {
+      double a = double(exact), b = double(n);
+      sum += (std::pow(b, 1 - theta) - std::pow(a, 1 - theta)) / (1 - theta)
+           + (std::pow(b, -theta) - std::pow(a, -theta)) / 2;
+    }
+    return sum;
+  }
+
+ public:
+  explicit zipfian(size_t n, double theta = 0.99)
+    : n(std::max<size_t>(n, 1)), theta(theta), alpha(1 / (1 - theta)), zetan(zeta(this->n, theta))
+  {
+    double zeta2 = zeta(2, theta);
+    eta = (1 - std::pow(2.0 / this->n, 1 - theta)) / (1 - zeta2 / zetan);
+  }
+
+  size_t operator()(splitmix64& rng) const {
+    double u = rng.unit();
+    double uz = u * zetan;
+    if (uz < 1) return 0;
+    if (uz < 1 + std::pow(0.5, theta)) return std::min<size_t>(1, n - 1);
+    size_t r = size_t(n * std::pow(eta * u - eta + 1, alpha));
+    return std::min(r, n - 1);
+  }
+};
+
+enum class keyOrder {
+  uniform,     // permutación aleatoria
+  sequential,  // ascendente
+  reverse,     // descendente
+  clustered,   // bloques de rangos consecutivos en orden aleatorio
+  adversarial, // de fuera hacia dentro: mínimo, máximo, siguiente mínimo...
+  zipfian      // n accesos con repetición, sesgados (sólo para búsquedas)
+};
+
+// Operaciones de YCSB. scan lee scanLength claves consecutivas a partir de
+// key; update y readModifyWrite reescriben una clave ya presente.
+enum class opType { read, update, insert, scan, readModifyWrite };
+
+struct operation {
+  opType type;
+  int key;
+  uint32_t scanLength;
+};
+
+class workload {
+  uint64_t seed;
+
+  splitmix64 rngFor(uint64_t tag, uint64_t stream) const {
+    splitmix64 mix(seed ^ (tag * 0x9e3779b97f4a7c15ull) ^ (stream << 32));
+    return splitmix64(mix.next());
+  }
+
+  // Dispersa los rangos calientes de Zipf por todo [0, n) (scrambled zipfian)
+  static size_t scramble(size_t rank, size_t n) {
+    splitmix64 h(rank);
+    return size_t(h.next() % n);
+  }
+
+ public:
+  static constexpr size_t CLUSTER = 64;
+
+  explicit workload(uint64_t seed = 42) : seed(seed) {}
+
+  static int presentKey(size_t rank) { return int(2 * rank); }
+  static int missingKey(size_t rank) { return int(2 * rank + 1); }
+
+  static keyOrder parseOrder(const std::string& name) {
+    if (name == "sequential") return keyOrder::sequential;
+    if (name == "reverse") return keyOrder::reverse;
+    if (name == "clustered") return keyOrder::clustered;
+    if (name == "adversarial") return keyOrder::adversarial;
+    if (name == "zipfian") return keyOrder::zipfian;
+    return keyOrder::uniform;
+  }
+
+  // Rangos 0..n-1 en el orden pedido. Para zipfian, n rangos con repetición.
+  std::vector<size_t> ranks(size_t n, keyOrder order, uint64_t stream = 0) const {
+    std::vector<size_t> r(n);
+    splitmix64 rng = rngFor(uint64_t(order) + 1, stream);
+    switch (order) {
+    case keyOrder::sequential:
+      for (size_t i = 0; i < n; i++) r[i] = i;
+      break;
+    case keyOrder::reverse:
+      for (size_t i = 0; i < n; i++) r[i] = n - 1 - i;
+      break;
+    case keyOrder::adversarial:
+      for (size_t i = 0, lo = 0, hi = n; i < n; i++) r[i] = (i % 2 == 0) ? lo++ : --hi;
+      break;
+    case keyOrder::clustered: {
+      std::vector<size_t> blocks((n + CLUSTER - 1) / CLUSTER);
+      for (size_t b = 0; b < blocks.size(); b++) blocks[b] = b;
+      shuffle(blocks, rng);
+      size_t i = 0;
+      for (size_t b : blocks)
+        for (size_t k = b * CLUSTER; k < std::min(n, (b + 1) * CLUSTER); k++) r[i++] = k;
+      break;
+    }
+    case keyOrder::zipfian: {
+      zipfian z(n);
+      for (size_t i = 0; i < n; i++) r[i] = scramble(z(rng), n);
+      break;
+    }
+    case keyOrder::uniform:
+      for (size_t i = 0; i < n; i++) r[i] = i;
+      shuffle(r, rng);
+      break;
+    }
+    return r;
+  }
+
+  // Las n claves presentes en el orden pedido
+  std::vector<int> keys(size_t n, keyOrder order, uint64_t stream = 0) const {
+    std::vector<size_t> r = ranks(n, order, stream);
+    std::vector<int> k(n);
+    for (size_t i = 0; i < n; i++) k[i] = presentKey(r[i]);
+    return k;
+  }
+
+  // count claves ausentes distintas, intercaladas con las presentes y en
+  // orden aleatorio
+  std::vector<int> missing(size_t count, uint64_t stream = 0) const {
+    std::vector<size_t> r = ranks(count, keyOrder::uniform, stream + 1000);
+    std::vector<int> k(count);
+    for (size_t i = 0; i < count; i++) k[i] = missingKey(r[i]);
+    return k;
+  }
+
+  // count operaciones de la carga YCSB id ('A'..'F') sobre un árbol con los
+  // rangos 0..loaded-1 ya insertados. Las inserciones usan rangos nuevos a
+  // partir de loaded. Distribución de claves Zipf (theta 0.99) dispersa,
+  // salvo D, que lee sobre todo lo último insertado.
+  //   A: 50% read, 50% update       D: 95% read, 5% insert
+  //   B: 95% read, 5% update        E: 95% scan (1-100), 5% insert
+  //   C: 100% read                  F: 50% read, 50% read-modify-write
+  std::vector<operation> ycsb(char id, size_t loaded, size_t count, uint64_t stream = 0) const {
+    std::vector<operation> ops(count);
+    splitmix64 rng = rngFor(100 + uint64_t(id), stream);
+    zipfian z(loaded);
+    size_t next = loaded;
+    for (operation& op : ops) {
+      double p = rng.unit();
+      size_t hot = z(rng);
+      size_t rank = scramble(hot, loaded);
+      op.scanLength = 0;
+      switch (id) {
+      case 'A': op.type = p < 0.5 ? opType::read : opType::update; break;
+      case 'B': op.type = p < 0.95 ? opType::read : opType::update; break;
+      case 'D':
+        op.type = p < 0.95 ? opType::read : opType::insert;
+        rank = next - 1 - std::min(hot, next - 1);
+        break;
+      case 'E':
+        op.type = p < 0.95 ? opType::scan : opType::insert;
+        op.scanLength = uint32_t(1 + rng.below(100));
+        break;
+      case 'F': op.type = p < 0.5 ? opType::read : opType::readModifyWrite; break;
+      default: op.type = opType::read; break;
+      }
+      if (op.type == opType::insert) rank = next++;
+      op.key = presentKey(rank);
+    }
+    return ops;
+  }
+
+  template<typename V>
+  static void shuffle(std::vector<V>& v, splitmix64& rng) {
+    for (size_t i = v.size(); i > 1; i--) std::swap(v[i - 1], v[rng.below(i)]);
+  }
+};
+
+#endif